@@ -26,6 +26,7 @@
 #include "wine/debug.h"
 
 WINE_DEFAULT_DEBUG_CHANNEL(dib);
+WINE_DECLARE_DEBUG_CHANNEL(font);
 
 struct cached_glyph
 {
@@ -40,19 +41,30 @@ enum glyph_type
     GLYPH_NBTYPES
 };
 
+/* glyphs are stored in pages of 256 entries, allocated on first use */
+#define GLYPH_CACHE_PAGE_SIZE 256
+#define GLYPH_CACHE_PAGES     (0x10000 / GLYPH_CACHE_PAGE_SIZE)
+
 struct cached_font
 {
-    struct list           entry;
+    struct list           entry;       /* entry in the most-recently used list */
+    struct list           hash_entry;  /* entry in the hash bucket */
     LONG                  ref;
     DWORD                 hash;
     LOGFONTW              lf;
     XFORM                 xform;
     UINT                  aa_flags;
-    UINT                  nb_glyphs[GLYPH_NBTYPES];
-    struct cached_glyph **glyphs[GLYPH_NBTYPES];
+    SIZE_T                size;        /* memory used by the cached glyphs */
+    struct cached_glyph **glyphs[GLYPH_NBTYPES][GLYPH_CACHE_PAGES];
 };
 
+#define FONT_CACHE_HASH_SIZE 64
+#define FONT_CACHE_MAX_SIZE  (4 * 1024 * 1024)  /* glyph memory kept for unused fonts */
+
 static struct list font_cache = LIST_INIT( font_cache );
+static struct list font_cache_buckets[FONT_CACHE_HASH_SIZE];
+static SIZE_T font_cache_size;
+static UINT font_cache_hits, font_cache_misses, glyph_cache_hits, glyph_cache_misses;
 
 static CRITICAL_SECTION font_cache_cs;
 static CRITICAL_SECTION_DEBUG critsect_debug =
@@ -90,6 +102,93 @@ static BOOL pen_region( dibdrv_physdev *pdev, HRGN region )
     return brush_rect( pdev, &pdev->pen_brush, NULL, region );
 }
 
+struct polygon_spans
+{
+    dibdrv_physdev      *pdev;
+    struct clipped_rects clip;      /* clip rectangles covering the polygon bounds */
+    int                  rop;
+    BOOL                 ret;
+    BOOL                 has_left;  /* left edge of the next span is pending */
+    int                  left;
+    int                  count;
+    RECT                 rects[128];
+};
+
+static void flush_polygon_spans( struct polygon_spans *spans )
+{
+    dibdrv_physdev *pdev = spans->pdev;
+
+    if (spans->count && !pdev->brush.rects( pdev, &pdev->brush, &pdev->dib,
+                                            spans->count, spans->rects, spans->rop ))
+        spans->ret = FALSE;
+    spans->count = 0;
+}
+
+static BOOL add_polygon_span_point( void *context, INT x, INT y )
+{
+    struct polygon_spans *spans = context;
+    RECT span;
+    int i;
+
+    if (!spans->has_left)
+    {
+        spans->left = x;
+        spans->has_left = TRUE;
+        return TRUE;
+    }
+    spans->has_left = FALSE;
+    if (spans->left >= x) return TRUE;
+
+    span.left   = spans->left;
+    span.top    = y;
+    span.right  = x;
+    span.bottom = y + 1;
+
+    for (i = 0; i < spans->clip.count; i++)
+    {
+        if (spans->clip.rects[i].bottom <= y) continue;
+        if (spans->clip.rects[i].top > y) break;
+        if (!intersect_rect( &spans->rects[spans->count], &span, &spans->clip.rects[i] )) continue;
+        if (++spans->count == sizeof(spans->rects) / sizeof(spans->rects[0]))
+            flush_polygon_spans( spans );
+    }
+    return TRUE;
+}
+
+/* fill the interior of polygons with the brush, feeding the scanline spans straight
+ * to the brush instead of building and clipping a region */
+static BOOL brush_polygons( dibdrv_physdev *pdev, const POINT *points, const INT *counts,
+                            DWORD polygons, INT mode )
+{
+    struct polygon_spans spans;
+    DWORD i, total;
+    RECT bounds;
+
+    reset_bounds( &bounds );
+    for (i = total = 0; i < polygons; i++) total += counts[i];
+    for (i = 0; i < total; i++)
+    {
+        bounds.left   = min( bounds.left, points[i].x );
+        bounds.top    = min( bounds.top, points[i].y );
+        bounds.right  = max( bounds.right, points[i].x + 1 );
+        bounds.bottom = max( bounds.bottom, points[i].y + 1 );
+    }
+
+    if (!get_clipped_rects( &pdev->dib, &bounds, pdev->clip, &spans.clip )) return TRUE;
+
+    spans.pdev     = pdev;
+    spans.rop      = GetROP2( pdev->dev.hdc );
+    spans.ret      = TRUE;
+    spans.has_left = FALSE;
+    spans.count    = 0;
+
+    if (!scan_convert_polypolygon( points, counts, polygons, mode, add_polygon_span_point, &spans ))
+        spans.ret = FALSE;
+    flush_polygon_spans( &spans );
+    free_clipped_rects( &spans.clip );
+    return spans.ret;
+}
+
 static RECT get_device_rect( HDC hdc, int left, int top, int right, int bottom, BOOL rtl_correction )
 {
     RECT rect;
@@ -376,22 +475,17 @@ static BOOL draw_arc( PHYSDEV dev, INT left, INT top, INT right, INT bottom,
         return FALSE;
     }
 
-    if (pdev->brush.style != BS_NULL && extra_lines > 0 &&
-        !(interior = CreatePolygonRgn( points, count, WINDING )))
+    /* if not using a region, paint the interior first so the outline can overlap it */
+    if (pdev->brush.style != BS_NULL && extra_lines > 0 && !outline)
+        ret = brush_polygons( pdev, points, &count, 1, WINDING );
+    else if (pdev->brush.style != BS_NULL && extra_lines > 0 &&
+             !(interior = CreatePolygonRgn( points, count, WINDING )))
     {
         HeapFree( GetProcessHeap(), 0, points );
         if (outline) DeleteObject( outline );
         return FALSE;
     }
 
-    /* if not using a region, paint the interior first so the outline can overlap it */
-    if (interior && !outline)
-    {
-        ret = brush_region( pdev, interior );
-        DeleteObject( interior );
-        interior = 0;
-    }
-
     reset_dash_origin( pdev );
     pdev->pen_lines( pdev, count, points, extra_lines > 0, outline );
     add_pen_lines_bounds( pdev, count, points, outline );
@@ -491,10 +585,47 @@ static int font_cache_cmp( const struct cached_font *p1, const struct cached_fon
     return ret;
 }
 
+static void free_cached_glyphs( struct cached_font *font )
+{
+    UINT i, j, k;
+
+    for (i = 0; i < GLYPH_NBTYPES; i++)
+    {
+        for (j = 0; j < GLYPH_CACHE_PAGES; j++)
+        {
+            if (!font->glyphs[i][j]) continue;
+            for (k = 0; k < GLYPH_CACHE_PAGE_SIZE; k++) HeapFree( GetProcessHeap(), 0, font->glyphs[i][j][k] );
+            HeapFree( GetProcessHeap(), 0, font->glyphs[i][j] );
+            font->glyphs[i][j] = NULL;
+        }
+    }
+    font_cache_size -= font->size;
+    font->size = 0;
+}
+
+/* drop the least recently used fonts that are not selected anywhere until
+ * the glyph memory fits in the budget again */
+static void trim_font_cache( void )
+{
+    struct cached_font *font, *next;
+
+    LIST_FOR_EACH_ENTRY_SAFE_REV( font, next, &font_cache, struct cached_font, entry )
+    {
+        if (font_cache_size <= FONT_CACHE_MAX_SIZE) break;
+        if (font->ref) continue;
+        TRACE_(font)( "evicting %p, %lu bytes\n", font, font->size );
+        free_cached_glyphs( font );
+        list_remove( &font->entry );
+        list_remove( &font->hash_entry );
+        HeapFree( GetProcessHeap(), 0, font );
+    }
+}
+
 static struct cached_font *add_cached_font( HDC hdc, HFONT hfont, UINT aa_flags )
 {
     struct cached_font font, *ptr, *last_unused = NULL;
-    UINT i = 0, j;
+    struct list *bucket;
+    UINT i = 0;
 
     GetObjectW( hfont, sizeof(font.lf), &font.lf );
     GetTransform( hdc, 0x204, &font.xform );
@@ -506,30 +637,38 @@ static struct cached_font *add_cached_font( HDC hdc, HFONT hfont, UINT aa_flags
     font.hash = font_cache_hash( &font );
 
     EnterCriticalSection( &font_cache_cs );
-    LIST_FOR_EACH_ENTRY( ptr, &font_cache, struct cached_font, entry )
+    if (!font_cache_buckets[0].next)
+        for (i = 0; i < FONT_CACHE_HASH_SIZE; i++) list_init( &font_cache_buckets[i] );
+
+    bucket = &font_cache_buckets[font.hash % FONT_CACHE_HASH_SIZE];
+    LIST_FOR_EACH_ENTRY( ptr, bucket, struct cached_font, hash_entry )
     {
         if (!font_cache_cmp( &font, ptr ))
         {
             InterlockedIncrement( &ptr->ref );
             list_remove( &ptr->entry );
+            font_cache_hits++;
             goto done;
         }
-        if (!ptr->ref)
-        {
-            i++;
-            last_unused = ptr;
-        }
+    }
+
+    font_cache_misses++;
+    TRACE_(font)( "font cache: %u hits, %u misses\n", font_cache_hits, font_cache_misses );
+
+    i = 0;
+    LIST_FOR_EACH_ENTRY( ptr, &font_cache, struct cached_font, entry )
+    {
+        if (ptr->ref) continue;
+        i++;
+        last_unused = ptr;
     }
 
     if (i > 5)  /* keep at least 5 of the most-recently used fonts around */
     {
         ptr = last_unused;
-        for (i = 0; i < GLYPH_NBTYPES; i++)
-        {
-            for (j = 0; j < ptr->nb_glyphs[i]; j++) HeapFree( GetProcessHeap(), 0, ptr->glyphs[i][j] );
-            HeapFree( GetProcessHeap(), 0, ptr->glyphs[i] );
-        }
+        free_cached_glyphs( ptr );
         list_remove( &ptr->entry );
+        list_remove( &ptr->hash_entry );
     }
     else if (!(ptr = HeapAlloc( GetProcessHeap(), 0, sizeof(*ptr) )))
     {
@@ -537,13 +676,14 @@ static struct cached_font *add_cached_font( HDC hdc, HFONT hfont, UINT aa_flags
         return NULL;
     }
 
-    *ptr = font;
-    ptr->ref = 1;
-    for (i = 0; i < GLYPH_NBTYPES; i++)
-    {
-        ptr->glyphs[i] = NULL;
-        ptr->nb_glyphs[i] = 0;
-    }
+    ptr->ref      = 1;
+    ptr->hash     = font.hash;
+    ptr->lf       = font.lf;
+    ptr->xform    = font.xform;
+    ptr->aa_flags = font.aa_flags;
+    ptr->size     = 0;
+    memset( ptr->glyphs, 0, sizeof(ptr->glyphs) );
+    list_add_head( bucket, &ptr->hash_entry );
 done:
     list_add_head( &font_cache, &ptr->entry );
     LeaveCriticalSection( &font_cache_cs );
@@ -556,33 +696,32 @@ void release_cached_font( struct cached_font *font )
     if (font) InterlockedDecrement( &font->ref );
 }
 
-static void add_cached_glyph( struct cached_font *font, UINT index, UINT flags, struct cached_glyph *glyph )
+static BOOL add_cached_glyph( struct cached_font *font, UINT index, UINT flags,
+                              struct cached_glyph *glyph, SIZE_T size )
 {
     enum glyph_type type = (flags & ETO_GLYPH_INDEX) ? GLYPH_INDEX : GLYPH_WCHAR;
+    struct cached_glyph ***page;
 
-    if (index >= font->nb_glyphs[type])
-    {
-        UINT new_count = (index + 128) & ~127;
-        struct cached_glyph **new;
-
-        if (font->glyphs[type])
-            new = HeapReAlloc( GetProcessHeap(), HEAP_ZERO_MEMORY,
-                               font->glyphs[type], new_count * sizeof(*new) );
-        else
-            new = HeapAlloc( GetProcessHeap(), HEAP_ZERO_MEMORY, new_count * sizeof(*new) );
-        if (!new) return;
-        font->glyphs[type] = new;
-        font->nb_glyphs[type] = new_count;
-    }
-    font->glyphs[type][index] = glyph;
+    if (index >= GLYPH_CACHE_PAGES * GLYPH_CACHE_PAGE_SIZE) return FALSE;
+    page = &font->glyphs[type][index / GLYPH_CACHE_PAGE_SIZE];
+    if (!*page && !(*page = HeapAlloc( GetProcessHeap(), HEAP_ZERO_MEMORY,
+                                       GLYPH_CACHE_PAGE_SIZE * sizeof(**page) )))
+        return FALSE;
+    (*page)[index % GLYPH_CACHE_PAGE_SIZE] = glyph;
+    font->size += size;
+    font_cache_size += size;
+    if (font_cache_size > FONT_CACHE_MAX_SIZE) trim_font_cache();
+    return TRUE;
 }
 
 static struct cached_glyph *get_cached_glyph( struct cached_font *font, UINT index, UINT flags )
 {
     enum glyph_type type = (flags & ETO_GLYPH_INDEX) ? GLYPH_INDEX : GLYPH_WCHAR;
+    struct cached_glyph **page;
 
-    if (index < font->nb_glyphs[type]) return font->glyphs[type][index];
-    return NULL;
+    if (index >= GLYPH_CACHE_PAGES * GLYPH_CACHE_PAGE_SIZE) return NULL;
+    if (!(page = font->glyphs[type][index / GLYPH_CACHE_PAGE_SIZE])) return NULL;
+    return page[index % GLYPH_CACHE_PAGE_SIZE];
 }
 
 /**********************************************************************
@@ -729,7 +868,11 @@ static struct cached_glyph *cache_glyph_bitmap( HDC hdc, struct cached_font *fon
 
 done:
     glyph->metrics = metrics;
-    add_cached_glyph( font, index, flags, glyph );
+    if (!add_cached_glyph( font, index, flags, glyph, FIELD_OFFSET( struct cached_glyph, bits[size] )))
+    {
+        HeapFree( GetProcessHeap(), 0, glyph );
+        return NULL;
+    }
     return glyph;
 }
 
@@ -757,8 +900,14 @@ static void render_string( HDC hdc, dib_info *dib, struct cached_font *font, INT
     EnterCriticalSection( &font_cache_cs );
     for (i = 0; i < count; i++)
     {
-        if (!(glyph = get_cached_glyph( font, str[i], flags )) &&
-            !(glyph = cache_glyph_bitmap( hdc, font, str[i], flags ))) continue;
+        if ((glyph = get_cached_glyph( font, str[i], flags ))) glyph_cache_hits++;
+        else
+        {
+            glyph_cache_misses++;
+            TRACE_(font)( "glyph cache: %u hits, %u misses, %lu bytes\n",
+                          glyph_cache_hits, glyph_cache_misses, font_cache_size );
+            if (!(glyph = cache_glyph_bitmap( hdc, font, str[i], flags ))) continue;
+        }
 
         glyph_dib.width       = glyph->metrics.gmBlackBoxX;
         glyph_dib.height      = glyph->metrics.gmBlackBoxY;
@@ -1165,8 +1314,11 @@ BOOL dibdrv_PolyPolygon( PHYSDEV dev, const POINT *pt, const INT *counts, DWORD
     memcpy( points, pt, total * sizeof(*pt) );
     LPtoDP( dev->hdc, points, total );
 
-    if (pdev->brush.style != BS_NULL &&
-        !(interior = CreatePolyPolygonRgn( points, counts, polygons, GetPolyFillMode( dev->hdc ))))
+    /* if not using a region, paint the interior first so the outline can overlap it */
+    if (pdev->brush.style != BS_NULL && !pdev->pen_uses_region)
+        ret = brush_polygons( pdev, points, counts, polygons, GetPolyFillMode( dev->hdc ));
+    else if (pdev->brush.style != BS_NULL &&
+             !(interior = CreatePolyPolygonRgn( points, counts, polygons, GetPolyFillMode( dev->hdc ))))
     {
         HeapFree( GetProcessHeap(), 0, points );
         return FALSE;
@@ -1174,7 +1326,6 @@ BOOL dibdrv_PolyPolygon( PHYSDEV dev, const POINT *pt, const INT *counts, DWORD
 
     if (pdev->pen_uses_region) outline = CreateRectRgn( 0, 0, 0, 0 );
 
-    /* if not using a region, paint the interior first so the outline can overlap it */
     if (interior && !outline)
     {
         ret = brush_region( pdev, interior );
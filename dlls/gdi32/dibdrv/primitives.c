@@ -4146,6 +4146,10 @@ static inline DWORD blend_argb( DWORD dst, DWORD src )
     BYTE g = (BYTE)(src >> 8);
     BYTE r = (BYTE)(src >> 16);
     DWORD alpha  = (BYTE)(src >> 24);
+
+    /* fully transparent and fully opaque pixels are the common case */
+    if (!src) return dst;
+    if (alpha == 255) return src;
     return ((b     + ((BYTE)dst         * (255 - alpha) + 127) / 255) |
             (g     + ((BYTE)(dst >> 8)  * (255 - alpha) + 127) / 255) << 8 |
             (r     + ((BYTE)(dst >> 16) * (255 - alpha) + 127) / 255) << 16 |
@@ -4154,9 +4158,12 @@ static inline DWORD blend_argb( DWORD dst, DWORD src )
 
 static inline DWORD blend_argb_alpha( DWORD dst, DWORD src, DWORD alpha )
 {
-    BYTE b = ((BYTE)src         * alpha + 127) / 255;
-    BYTE g = ((BYTE)(src >> 8)  * alpha + 127) / 255;
-    BYTE r = ((BYTE)(src >> 16) * alpha + 127) / 255;
+    BYTE b, g, r;
+
+    if (!src) return dst;
+    b = ((BYTE)src         * alpha + 127) / 255;
+    g = ((BYTE)(src >> 8)  * alpha + 127) / 255;
+    r = ((BYTE)(src >> 16) * alpha + 127) / 255;
     alpha  = ((BYTE)(src >> 24) * alpha + 127) / 255;
     return ((b     + ((BYTE)dst         * (255 - alpha) + 127) / 255) |
             (g     + ((BYTE)(dst >> 8)  * (255 - alpha) + 127) / 255) << 8 |
@@ -4189,6 +4196,9 @@ static void blend_rect_8888(const dib_info *dst, const RECT *rc,
     DWORD *dst_ptr = get_pixel_ptr_32( dst, rc->left, rc->top );
     int x, y;
 
+    /* a zero constant alpha leaves every destination pixel unchanged */
+    if (!blend.SourceConstantAlpha) return;
+
     if (blend.AlphaFormat & AC_SRC_ALPHA)
     {
 	if (blend.SourceConstantAlpha == 255)
@@ -4201,9 +4211,19 @@ static void blend_rect_8888(const dib_info *dst, const RECT *rc,
 		    dst_ptr[x] = blend_argb_alpha( dst_ptr[x], src_ptr[x], blend.SourceConstantAlpha );
     }
     else if (src->compression == BI_RGB)
+    {
+        if (blend.SourceConstantAlpha == 255)
+            for (y = rc->top; y < rc->bottom; y++, dst_ptr += dst->stride / 4, src_ptr += src->stride / 4)
+                memmove( dst_ptr, src_ptr, (rc->right - rc->left) * 4 );
+        else
+            for (y = rc->top; y < rc->bottom; y++, dst_ptr += dst->stride / 4, src_ptr += src->stride / 4)
+                for (x = 0; x < rc->right - rc->left; x++)
+                    dst_ptr[x] = blend_argb_constant_alpha( dst_ptr[x], src_ptr[x], blend.SourceConstantAlpha );
+    }
+    else if (blend.SourceConstantAlpha == 255)
 	for (y = rc->top; y < rc->bottom; y++, dst_ptr += dst->stride / 4, src_ptr += src->stride / 4)
 	    for (x = 0; x < rc->right - rc->left; x++)
-		dst_ptr[x] = blend_argb_constant_alpha( dst_ptr[x], src_ptr[x], blend.SourceConstantAlpha );
+		dst_ptr[x] = src_ptr[x] | 0xff000000;
     else
 	for (y = rc->top; y < rc->bottom; y++, dst_ptr += dst->stride / 4, src_ptr += src->stride / 4)
 	    for (x = 0; x < rc->right - rc->left; x++)
@@ -5171,6 +5191,8 @@ static void draw_subpixel_glyph_8888( const dib_info *dib, const RECT *rect, con
         for (x = 0; x < rect->right - rect->left; x++)
         {
             if (glyph_ptr[x] == 0) continue;
+            /* full coverage on all three subpixels gives the plain text color */
+            if ((glyph_ptr[x] & 0xffffff) == 0xffffff) { dst_ptr[x] = text_pixel & 0xffffff; continue; }
             dst_ptr[x] = blend_subpixel( dst_ptr[x] >> 16, dst_ptr[x] >> 8, dst_ptr[x], text_pixel, glyph_ptr[x] );
         }
         dst_ptr += dib->stride / 4;
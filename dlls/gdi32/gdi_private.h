@@ -329,6 +329,9 @@ extern HPALETTE PALETTE_Init(void) DECLSPEC_HIDDEN;
 extern BOOL add_rect_to_region( HRGN rgn, const RECT *rect ) DECLSPEC_HIDDEN;
 extern INT mirror_region( HRGN dst, HRGN src, INT width ) DECLSPEC_HIDDEN;
 extern BOOL REGION_FrameRgn( HRGN dest, HRGN src, INT x, INT y ) DECLSPEC_HIDDEN;
+typedef BOOL (*scan_point_func)( void *context, INT x, INT y );
+extern BOOL scan_convert_polypolygon( const POINT *pts, const INT *count, INT polygons, INT mode,
+                                      scan_point_func func, void *context ) DECLSPEC_HIDDEN;
 
 typedef struct
 {
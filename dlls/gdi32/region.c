@@ -2747,56 +2747,35 @@ static BOOL REGION_PtsToRegion(int numFullPtBlocks, int iCurPtBlock,
 }
 
 /***********************************************************************
- *           CreatePolyPolygonRgn    (GDI32.@)
+ *           scan_convert_polypolygon
+ *
+ * Scan convert a set of polygons, passing the edge crossings of each
+ * scanline to the callback. Consecutive crossings on a scanline form
+ * the [left, right) spans of the interior.
  */
-HRGN WINAPI CreatePolyPolygonRgn(const POINT *Pts, const INT *Count,
-		      INT nbpolygons, INT mode)
+BOOL scan_convert_polypolygon( const POINT *Pts, const INT *Count, INT nbpolygons, INT mode,
+                               scan_point_func func, void *context )
 {
-    HRGN hrgn = 0;
-    WINEREGION *obj;
     EdgeTableEntry *pAET;            /* Active Edge Table       */
     INT y;                           /* current scanline        */
-    int iPts = 0;                    /* number of pts in buffer */
     EdgeTableEntry *pWETE;           /* Winding Edge Table Entry*/
     ScanLineList *pSLL;              /* current scanLineList    */
-    POINT *pts;                      /* output buffer           */
     EdgeTableEntry *pPrevAET;        /* ptr to previous AET     */
     EdgeTable ET;                    /* header node for ET      */
     EdgeTableEntry AET;              /* header node for AET     */
     EdgeTableEntry *pETEs;           /* EdgeTableEntries pool   */
     ScanLineListBlock SLLBlock;      /* header for scanlinelist */
     int fixWAET = FALSE;
-    POINTBLOCK FirstPtBlock, *curPtBlock; /* PtBlock buffers    */
-    POINTBLOCK *tmpPtBlock;
-    int numFullPtBlocks = 0;
     INT poly, total;
-
-    TRACE("%p, count %d, polygons %d, mode %d\n", Pts, *Count, nbpolygons, mode);
-
-    /* special case a rectangle */
-
-    if (((nbpolygons == 1) && ((*Count == 4) ||
-       ((*Count == 5) && (Pts[4].x == Pts[0].x) && (Pts[4].y == Pts[0].y)))) &&
-	(((Pts[0].y == Pts[1].y) &&
-	  (Pts[1].x == Pts[2].x) &&
-	  (Pts[2].y == Pts[3].y) &&
-	  (Pts[3].x == Pts[0].x)) ||
-	 ((Pts[0].x == Pts[1].x) &&
-	  (Pts[1].y == Pts[2].y) &&
-	  (Pts[2].x == Pts[3].x) &&
-	  (Pts[3].y == Pts[0].y))))
-        return CreateRectRgn( min(Pts[0].x, Pts[2].x), min(Pts[0].y, Pts[2].y),
-                              max(Pts[0].x, Pts[2].x), max(Pts[0].y, Pts[2].y) );
+    BOOL ret = FALSE;
 
     for(poly = total = 0; poly < nbpolygons; poly++)
         total += Count[poly];
     if (! (pETEs = HeapAlloc( GetProcessHeap(), 0, sizeof(EdgeTableEntry) * total )))
-	return 0;
+	return FALSE;
 
-    pts = FirstPtBlock.pts;
     REGION_CreateETandAET(Count, nbpolygons, Pts, &ET, &AET, pETEs, &SLLBlock);
     pSLL = ET.scanlines.next;
-    curPtBlock = &FirstPtBlock;
 
     if (mode != WINDING) {
         /*
@@ -2818,21 +2797,7 @@ HRGN WINAPI CreatePolyPolygonRgn(const POINT *Pts, const INT *Count,
              *  for each active edge
              */
             while (pAET) {
-                pts->x = pAET->bres.minor_axis,  pts->y = y;
-                pts++, iPts++;
-
-                /*
-                 *  send out the buffer
-                 */
-                if (iPts == NUMPTSTOBUFFER) {
-                    tmpPtBlock = HeapAlloc( GetProcessHeap(), 0, sizeof(POINTBLOCK));
-		    if(!tmpPtBlock) goto done;
-                    curPtBlock->next = tmpPtBlock;
-                    curPtBlock = tmpPtBlock;
-                    pts = curPtBlock->pts;
-                    numFullPtBlocks++;
-                    iPts = 0;
-                }
+                if (!func( context, pAET->bres.minor_axis, y )) goto done;
                 EVALUATEEDGEEVENODD(pAET, pPrevAET, y);
             }
             REGION_InsertionSort(&AET);
@@ -2865,22 +2830,7 @@ HRGN WINAPI CreatePolyPolygonRgn(const POINT *Pts, const INT *Count,
                  *  are in the Winding active edge table.
                  */
                 if (pWETE == pAET) {
-                    pts->x = pAET->bres.minor_axis,  pts->y = y;
-                    pts++, iPts++;
-
-                    /*
-                     *  send out the buffer
-                     */
-                    if (iPts == NUMPTSTOBUFFER) {
-                        tmpPtBlock = HeapAlloc( GetProcessHeap(), 0,
-					       sizeof(POINTBLOCK) );
-			if(!tmpPtBlock) goto done;
-                        curPtBlock->next = tmpPtBlock;
-                        curPtBlock = tmpPtBlock;
-                        pts = curPtBlock->pts;
-                        numFullPtBlocks++;
-                        iPts = 0;
-                    }
+                    if (!func( context, pAET->bres.minor_axis, y )) goto done;
                     pWETE = pWETE->nextWETE;
                 }
                 EVALUATEEDGEWINDING(pAET, pPrevAET, y, fixWAET);
@@ -2896,10 +2846,84 @@ HRGN WINAPI CreatePolyPolygonRgn(const POINT *Pts, const INT *Count,
             }
         }
     }
+    ret = TRUE;
+
+done:
+    REGION_FreeStorage(SLLBlock.next);
+    HeapFree( GetProcessHeap(), 0, pETEs );
+    return ret;
+}
+
+struct point_blocks
+{
+    POINTBLOCK  first;
+    POINTBLOCK *cur;
+    POINT      *pts;
+    int         numFullPtBlocks;
+    int         iPts;
+};
+
+static BOOL add_point_to_blocks( void *context, INT x, INT y )
+{
+    struct point_blocks *blocks = context;
+    POINTBLOCK *tmpPtBlock;
+
+    blocks->pts->x = x,  blocks->pts->y = y;
+    blocks->pts++, blocks->iPts++;
+
+    /*
+     *  send out the buffer
+     */
+    if (blocks->iPts == NUMPTSTOBUFFER) {
+        if (!(tmpPtBlock = HeapAlloc( GetProcessHeap(), 0, sizeof(POINTBLOCK) ))) return FALSE;
+        blocks->cur->next = tmpPtBlock;
+        blocks->cur = tmpPtBlock;
+        blocks->pts = tmpPtBlock->pts;
+        blocks->numFullPtBlocks++;
+        blocks->iPts = 0;
+    }
+    return TRUE;
+}
+
+/***********************************************************************
+ *           CreatePolyPolygonRgn    (GDI32.@)
+ */
+HRGN WINAPI CreatePolyPolygonRgn(const POINT *Pts, const INT *Count,
+		      INT nbpolygons, INT mode)
+{
+    HRGN hrgn = 0;
+    WINEREGION *obj;
+    struct point_blocks blocks;
+    POINTBLOCK *curPtBlock, *tmpPtBlock;
+
+    TRACE("%p, count %d, polygons %d, mode %d\n", Pts, *Count, nbpolygons, mode);
+
+    /* special case a rectangle */
+
+    if (((nbpolygons == 1) && ((*Count == 4) ||
+       ((*Count == 5) && (Pts[4].x == Pts[0].x) && (Pts[4].y == Pts[0].y)))) &&
+	(((Pts[0].y == Pts[1].y) &&
+	  (Pts[1].x == Pts[2].x) &&
+	  (Pts[2].y == Pts[3].y) &&
+	  (Pts[3].x == Pts[0].x)) ||
+	 ((Pts[0].x == Pts[1].x) &&
+	  (Pts[1].y == Pts[2].y) &&
+	  (Pts[2].x == Pts[3].x) &&
+	  (Pts[3].y == Pts[0].y))))
+        return CreateRectRgn( min(Pts[0].x, Pts[2].x), min(Pts[0].y, Pts[2].y),
+                              max(Pts[0].x, Pts[2].x), max(Pts[0].y, Pts[2].y) );
+
+    blocks.cur = &blocks.first;
+    blocks.pts = blocks.first.pts;
+    blocks.numFullPtBlocks = 0;
+    blocks.iPts = 0;
+
+    if (!scan_convert_polypolygon( Pts, Count, nbpolygons, mode, add_point_to_blocks, &blocks ))
+        goto done;
 
     if (!(obj = HeapAlloc( GetProcessHeap(), 0, sizeof(*obj) ))) goto done;
 
-    if (!REGION_PtsToRegion(numFullPtBlocks, iPts, &FirstPtBlock, obj))
+    if (!REGION_PtsToRegion(blocks.numFullPtBlocks, blocks.iPts, &blocks.first, obj))
     {
         HeapFree( GetProcessHeap(), 0, obj );
         goto done;
@@ -2911,13 +2935,11 @@ HRGN WINAPI CreatePolyPolygonRgn(const POINT *Pts, const INT *Count,
     }
 
 done:
-    REGION_FreeStorage(SLLBlock.next);
-    for (curPtBlock = FirstPtBlock.next; --numFullPtBlocks >= 0;) {
+    for (curPtBlock = blocks.first.next; --blocks.numFullPtBlocks >= 0;) {
 	tmpPtBlock = curPtBlock->next;
 	HeapFree( GetProcessHeap(), 0, curPtBlock );
 	curPtBlock = tmpPtBlock;
     }
-    HeapFree( GetProcessHeap(), 0, pETEs );
     return hrgn;
 }
 
@@ -945,6 +945,172 @@ static ARGB resample_bitmap_pixel(GDIPCONST GpRect *src_rect, LPBYTE bits, UINT
     }
 }
 
+#define SAMPLE_OUTSIDE -1
+#define SAMPLE_INVALID -2
+
+/* Sampling parameters shared by a whole row or column of an axis-aligned image. */
+typedef struct
+{
+    BOOL inside;    /* whether the position is within the source rectangle */
+    BOOL single;    /* whether both source pixels are the same */
+    INT pos[2];     /* src_rect relative source pixels, or SAMPLE_* values */
+    REAL weight;    /* weight of the second source pixel */
+} sample_coord_t;
+
+/* Does the per-axis part of sample_bitmap_pixel. */
+static INT map_sample_coord(GDIPCONST GpImageAttributes *attributes, BOOL flip, UINT size,
+    INT rect_pos, INT rect_size, INT x)
+{
+    if (attributes->wrap == WrapModeClamp)
+    {
+        if (x < 0 || x >= size)
+            return SAMPLE_OUTSIDE;
+    }
+    else
+    {
+        if (x < 0)
+            x = size*2 + x % (size * 2);
+
+        if (flip)
+        {
+            if ((x / size) % 2 == 0)
+                x = x % size;
+            else
+                x = size - 1 - x % size;
+        }
+        else
+            x = x % size;
+    }
+
+    if (x < rect_pos || x >= rect_pos + rect_size)
+        return SAMPLE_INVALID;
+
+    return x - rect_pos;
+}
+
+static void get_sample_coords(sample_coord_t *coords, INT first, INT count, REAL origin, REAL step,
+    REAL src_start, REAL src_end, BOOL vertical, GDIPCONST GpRect *src_rect, GpBitmap *bitmap,
+    GDIPCONST GpImageAttributes *attributes, InterpolationMode interpolation, PixelOffsetMode offset_mode)
+{
+    UINT size = vertical ? bitmap->height : bitmap->width;
+    INT rect_pos = vertical ? src_rect->Y : src_rect->X;
+    INT rect_size = vertical ? src_rect->Height : src_rect->Width;
+    BOOL flip = (attributes->wrap & (vertical ? 2 : 1)) != 0;
+    FLOAT pixel_offset;
+    INT i;
+
+    if (offset_mode == PixelOffsetModeHalf || offset_mode == PixelOffsetModeHighQuality)
+        pixel_offset = 0.0;
+    else
+        pixel_offset = 0.5;
+
+    for (i = 0; i < count; i++)
+    {
+        REAL pos = origin + (first + i) * step;
+
+        coords[i].inside = pos >= src_start && pos < src_end;
+
+        if (interpolation == InterpolationModeNearestNeighbor)
+        {
+            coords[i].single = TRUE;
+            coords[i].pos[0] = coords[i].pos[1] = map_sample_coord(attributes, flip, size,
+                rect_pos, rect_size, floorf(pos + pixel_offset));
+            coords[i].weight = 0.0;
+        }
+        else
+        {
+            REAL low = floorf(pos);
+            INT high = (INT)ceilf(pos);
+
+            coords[i].single = (INT)low == high;
+            coords[i].pos[0] = map_sample_coord(attributes, flip, size, rect_pos, rect_size, low);
+            coords[i].pos[1] = map_sample_coord(attributes, flip, size, rect_pos, rect_size, high);
+            coords[i].weight = pos - low;
+        }
+    }
+}
+
+static inline ARGB sample_coords_pixel(LPBYTE bits, INT stride, INT x, INT y,
+    GDIPCONST GpImageAttributes *attributes)
+{
+    if (x == SAMPLE_OUTSIDE || y == SAMPLE_OUTSIDE)
+        return attributes->outside_color;
+
+    if (x == SAMPLE_INVALID || y == SAMPLE_INVALID)
+    {
+        ERR("out of range pixel requested\n");
+        return 0xffcd0084;
+    }
+
+    return ((DWORD*)bits)[x + y * stride];
+}
+
+/* Same as calling resample_bitmap_pixel for each destination pixel of an image
+ * that's only scaled and translated, but with the sampling parameters computed
+ * once per row and column. Returns FALSE if the tables couldn't be allocated. */
+static BOOL resample_scaled_bitmap(GpBitmap *bitmap, GDIPCONST GpRect *src_rect, LPBYTE src_data,
+    REAL srcx, REAL srcy, REAL srcwidth, REAL srcheight, const GpPointF *origin, REAL x_dx, REAL y_dy,
+    GDIPCONST GpImageAttributes *attributes, InterpolationMode interpolation, PixelOffsetMode offset_mode,
+    const RECT *dst_area, LPBYTE dst_data, INT dst_stride)
+{
+    INT width = dst_area->right - dst_area->left, height = dst_area->bottom - dst_area->top;
+    sample_coord_t *cols, *rows;
+    static int fixme;
+    INT x, y;
+
+    cols = GdipAlloc(sizeof(*cols) * (width + height));
+    if (!cols)
+        return FALSE;
+    rows = cols + width;
+
+    if (interpolation != InterpolationModeBilinear && interpolation != InterpolationModeNearestNeighbor)
+    {
+        if (!fixme++)
+            FIXME("Unimplemented interpolation %i\n", interpolation);
+        interpolation = InterpolationModeBilinear;
+    }
+
+    get_sample_coords(cols, dst_area->left, width, origin->X, x_dx, srcx, srcx + srcwidth, FALSE,
+        src_rect, bitmap, attributes, interpolation, offset_mode);
+    get_sample_coords(rows, dst_area->top, height, origin->Y, y_dy, srcy, srcy + srcheight, TRUE,
+        src_rect, bitmap, attributes, interpolation, offset_mode);
+
+    for (y = 0; y < height; y++)
+    {
+        const sample_coord_t *row = rows + y;
+        ARGB *dst_color = (ARGB*)(dst_data + dst_stride * y);
+
+        for (x = 0; x < width; x++)
+        {
+            const sample_coord_t *col = cols + x;
+            ARGB top, bottom;
+
+            if (!col->inside || !row->inside)
+            {
+                dst_color[x] = 0;
+                continue;
+            }
+
+            if (col->single && row->single)
+            {
+                dst_color[x] = sample_coords_pixel(src_data, src_rect->Width, col->pos[0], row->pos[0], attributes);
+                continue;
+            }
+
+            top = blend_colors(sample_coords_pixel(src_data, src_rect->Width, col->pos[0], row->pos[0], attributes),
+                               sample_coords_pixel(src_data, src_rect->Width, col->pos[1], row->pos[0], attributes),
+                               col->weight);
+            bottom = blend_colors(sample_coords_pixel(src_data, src_rect->Width, col->pos[0], row->pos[1], attributes),
+                                  sample_coords_pixel(src_data, src_rect->Width, col->pos[1], row->pos[1], attributes),
+                                  col->weight);
+            dst_color[x] = blend_colors(top, bottom, row->weight);
+        }
+    }
+
+    GdipFree(cols);
+    return TRUE;
+}
+
 static REAL intersect_line_scanline(const GpPointF *p1, const GpPointF *p2, REAL y)
 {
     return (p1->X - p2->X) * (p2->Y - y) / (p2->Y - p1->Y) + p2->X;
@@ -3286,23 +3452,30 @@ GpStatus WINGDIPAPI GdipDrawImagePointsRect(GpGraphics *graphics, GpImage *image
             y_dx = dst_to_src_points[2].X - dst_to_src_points[0].X;
             y_dy = dst_to_src_points[2].Y - dst_to_src_points[0].Y;
 
-            for (x=dst_area.left; x<dst_area.right; x++)
+            /* Scaled images can be resampled one row and column at a time. */
+            if (x_dy != 0.0 || y_dx != 0.0 ||
+                !resample_scaled_bitmap(bitmap, &src_area, src_data, srcx, srcy, srcwidth, srcheight,
+                    &dst_to_src_points[0], x_dx, y_dy, imageAttributes, interpolation, offset_mode,
+                    &dst_area, dst_data, dst_stride))
             {
                 for (y=dst_area.top; y<dst_area.bottom; y++)
                 {
-                    GpPointF src_pointf;
-                    ARGB *dst_color;
+                    for (x=dst_area.left; x<dst_area.right; x++)
+                    {
+                        GpPointF src_pointf;
+                        ARGB *dst_color;
 
-                    src_pointf.X = dst_to_src_points[0].X + x * x_dx + y * y_dx;
-                    src_pointf.Y = dst_to_src_points[0].Y + x * x_dy + y * y_dy;
+                        src_pointf.X = dst_to_src_points[0].X + x * x_dx + y * y_dx;
+                        src_pointf.Y = dst_to_src_points[0].Y + x * x_dy + y * y_dy;
 
-                    dst_color = (ARGB*)(dst_data + dst_stride * (y - dst_area.top) + sizeof(ARGB) * (x - dst_area.left));
+                        dst_color = (ARGB*)(dst_data + dst_stride * (y - dst_area.top) + sizeof(ARGB) * (x - dst_area.left));
 
-                    if (src_pointf.X >= srcx && src_pointf.X < srcx + srcwidth && src_pointf.Y >= srcy && src_pointf.Y < srcy+srcheight)
-                        *dst_color = resample_bitmap_pixel(&src_area, src_data, bitmap->width, bitmap->height, &src_pointf,
-                                                           imageAttributes, interpolation, offset_mode);
-                    else
-                        *dst_color = 0;
+                        if (src_pointf.X >= srcx && src_pointf.X < srcx + srcwidth && src_pointf.Y >= srcy && src_pointf.Y < srcy+srcheight)
+                            *dst_color = resample_bitmap_pixel(&src_area, src_data, bitmap->width, bitmap->height, &src_pointf,
+                                                               imageAttributes, interpolation, offset_mode);
+                        else
+                            *dst_color = 0;
+                    }
                 }
             }
 
@@ -1824,6 +1824,7 @@ void release_bytecode(bytecode_t *code)
     jsheap_free(&code->heap);
     heap_free(code->bstr_pool);
     heap_free(code->str_pool);
+    heap_free(code->prop_cache);
     heap_free(code->instrs);
     heap_free(code);
 }
@@ -2428,9 +2428,11 @@ static HRESULT DateConstr_value(script_ctx_t *ctx, vdisp_t *jsthis, WORD flags,
             if(FAILED(hres))
                 return hres;
 
-            if(is_string(prim))
-                hres = date_parse(get_string(prim), &n);
-            else
+            if(is_string(prim)) {
+                jsstr_t *str = jsstr_flatten(get_string(prim));
+
+                hres = str ? date_parse(str, &n) : E_OUTOFMEMORY;
+            }else
                 hres = to_number(ctx, prim, &n);
 
             jsval_release(prim);
@@ -152,10 +152,61 @@ static inline HRESULT resize_props(jsdisp_t *This)
     return S_OK;
 }
 
+/* Index properties stay at a fixed position in the props array, so the position of
+ * densely used indexes is remembered to avoid formatting and hashing their names. */
+#define MAX_DENSE_IDX 0x1000000
+
+static BOOL is_dense_idx_name(const WCHAR *name, DWORD *ret)
+{
+    DWORD idx = 0;
+
+    if(!isdigitW(*name) || (*name == '0' && name[1]))
+        return FALSE;
+
+    for(; isdigitW(*name) && idx < MAX_DENSE_IDX; name++)
+        idx = idx*10 + (*name-'0');
+    if(*name || idx >= MAX_DENSE_IDX)
+        return FALSE;
+
+    *ret = idx;
+    return TRUE;
+}
+
+static void add_dense_idx(jsdisp_t *This, DWORD idx, DWORD pos)
+{
+    if(idx >= This->idx_size) {
+        DWORD new_size, *new_props;
+
+        /* don't bother with sparse indexes, they are found by name */
+        if(idx >= This->idx_size*2 + 64)
+            return;
+
+        new_size = max(This->idx_size*2, 64);
+        while(new_size <= idx)
+            new_size *= 2;
+        new_props = heap_realloc(This->idx_props, new_size*sizeof(*new_props));
+        if(!new_props)
+            return;
+        memset(new_props+This->idx_size, 0, (new_size-This->idx_size)*sizeof(*new_props));
+        This->idx_props = new_props;
+        This->idx_size = new_size;
+    }
+
+    This->idx_props[idx] = pos;
+}
+
+static inline dispex_prop_t *find_dense_idx(jsdisp_t *This, DWORD idx)
+{
+    if(idx >= This->idx_size || !This->idx_props[idx])
+        return NULL;
+    return This->props + This->idx_props[idx];
+}
+
 static inline dispex_prop_t* alloc_prop(jsdisp_t *This, const WCHAR *name, prop_type_t type, DWORD flags)
 {
     dispex_prop_t *prop;
     unsigned bucket;
+    DWORD idx;
 
     if(FAILED(resize_props(This)))
         return NULL;
@@ -170,7 +221,11 @@ static inline dispex_prop_t* alloc_prop(jsdisp_t *This, const WCHAR *name, prop_
 
     bucket = get_props_idx(This, prop->hash);
     prop->bucket_next = This->props[bucket].bucket_head;
-    This->props[bucket].bucket_head = This->prop_cnt++;
+    This->props[bucket].bucket_head = This->prop_cnt;
+
+    if(is_dense_idx_name(name, &idx))
+        add_dense_idx(This, idx, This->prop_cnt);
+    This->prop_cnt++;
     return prop;
 }
 
@@ -901,6 +956,8 @@ HRESULT init_dispex(jsdisp_t *dispex, script_ctx_t *ctx, const builtin_info_t *b
     dispex->props = heap_alloc_zero(sizeof(dispex_prop_t)*(dispex->buf_size=4));
     if(!dispex->props)
         return E_OUTOFMEMORY;
+    dispex->idx_size = 0;
+    dispex->idx_props = NULL;
 
     dispex->prototype = prototype;
     if(prototype)
@@ -959,6 +1016,7 @@ void jsdisp_free(jsdisp_t *obj)
         heap_free(prop->name);
     }
     heap_free(obj->props);
+    heap_free(obj->idx_props);
     script_release(obj->ctx);
     if(obj->prototype)
         jsdisp_release(obj->prototype);
@@ -1053,6 +1111,20 @@ HRESULT jsdisp_get_id(jsdisp_t *jsdisp, const WCHAR *name, DWORD flags, DISPID *
     return DISP_E_UNKNOWNNAME;
 }
 
+/*
+ * Returns TRUE if id still refers to a live property of jsdisp called name, that is
+ * if jsdisp_get_id would return the same id for that name. Property names are unique
+ * within an object and properties are never moved, so this is enough to validate
+ * a cached id.
+ */
+BOOL jsdisp_is_prop_id(jsdisp_t *jsdisp, DISPID id, const WCHAR *name)
+{
+    dispex_prop_t *prop;
+
+    prop = get_prop(jsdisp, id);
+    return prop && prop->name && !strcmpW(prop->name, name);
+}
+
 HRESULT jsdisp_call_value(jsdisp_t *jsfunc, IDispatch *jsthis, WORD flags, unsigned argc, jsval_t *argv, jsval_t *r)
 {
     HRESULT hres;
@@ -1311,10 +1383,20 @@ HRESULT jsdisp_propput_dontenum(jsdisp_t *obj, const WCHAR *name, jsval_t val)
 
 HRESULT jsdisp_propput_idx(jsdisp_t *obj, DWORD idx, jsval_t val)
 {
+    dispex_prop_t *prop;
     WCHAR buf[12];
 
     static const WCHAR formatW[] = {'%','d',0};
 
+    if((prop = find_dense_idx(obj, idx))) {
+        if(prop->type == PROP_DELETED) {
+            prop->type = PROP_JSVAL;
+            prop->flags = PROPF_ENUM;
+            prop->u.val = jsval_undefined();
+        }
+        return prop_put(obj, prop, val, NULL);
+    }
+
     sprintfW(buf, formatW, idx);
     return jsdisp_propput_name(obj, buf, val);
 }
@@ -1391,6 +1473,9 @@ HRESULT jsdisp_get_idx(jsdisp_t *obj, DWORD idx, jsval_t *r)
 
     static const WCHAR formatW[] = {'%','d',0};
 
+    if((prop = find_dense_idx(obj, idx)) && prop->type != PROP_DELETED)
+        return prop_get(obj, prop, &dp, r, NULL);
+
     sprintfW(name, formatW, idx);
 
     hres = find_prop_name_prot(obj, string_hash(name), name, &prop);
@@ -1461,6 +1546,9 @@ HRESULT jsdisp_delete_idx(jsdisp_t *obj, DWORD idx)
     BOOL b;
     HRESULT hres;
 
+    if((prop = find_dense_idx(obj, idx)))
+        return delete_prop(prop, &b);
+
     sprintfW(buf, formatW, idx);
 
     hres = find_prop_name(obj, string_hash(buf), buf, &prop);
@@ -377,6 +377,60 @@ static HRESULT disp_get_id(script_ctx_t *ctx, IDispatch *disp, WCHAR *name, BSTR
     return IDispatch_GetIDsOfNames(disp, &IID_NULL, &name, 1, 0, id);
 }
 
+/*
+ * Each bytecode has a small direct-mapped cache, indexed by instruction offset, of the
+ * last DISPID that instruction resolved on a script object. Entries are validated against
+ * the object actually used, so they are only a lookup hint and never need invalidation.
+ */
+static BOOL lookup_prop_cache(exec_ctx_t *ctx, jsdisp_t *jsdisp, const WCHAR *name, DISPID *id)
+{
+    prop_cache_entry_t *entry;
+
+    if(!ctx->code->prop_cache)
+        return FALSE;
+
+    entry = ctx->code->prop_cache + ctx->ip % PROP_CACHE_SIZE;
+    if(entry->ip != ctx->ip || !jsdisp_is_prop_id(jsdisp, entry->id, name))
+        return FALSE;
+
+    *id = entry->id;
+    return TRUE;
+}
+
+static void update_prop_cache(exec_ctx_t *ctx, DISPID id)
+{
+    prop_cache_entry_t *entry;
+
+    if(!ctx->code->prop_cache) {
+        ctx->code->prop_cache = heap_alloc_zero(PROP_CACHE_SIZE * sizeof(*ctx->code->prop_cache));
+        if(!ctx->code->prop_cache)
+            return;
+    }
+
+    entry = ctx->code->prop_cache + ctx->ip % PROP_CACHE_SIZE;
+    entry->ip = ctx->ip;
+    entry->id = id;
+}
+
+static HRESULT exec_get_id(exec_ctx_t *ctx, IDispatch *disp, WCHAR *name, BSTR name_bstr, DWORD flags, DISPID *id)
+{
+    jsdisp_t *jsdisp;
+    HRESULT hres = S_OK;
+
+    jsdisp = iface_to_jsdisp((IUnknown*)disp);
+    if(!jsdisp)
+        return disp_get_id(ctx->script, disp, name, name_bstr, flags, id);
+
+    if(!lookup_prop_cache(ctx, jsdisp, name, id)) {
+        hres = jsdisp_get_id(jsdisp, name, flags, id);
+        if(SUCCEEDED(hres))
+            update_prop_cache(ctx, *id);
+    }
+
+    jsdisp_release(jsdisp);
+    return hres;
+}
+
 static inline BOOL var_is_null(const VARIANT *v)
 {
     return V_VT(v) == VT_NULL || (V_VT(v) == VT_DISPATCH && !V_DISPATCH(v));
@@ -448,9 +502,17 @@ static HRESULT equal2_values(jsval_t lval, jsval_t rval, BOOL *ret)
         break;
     case JSV_OBJECT:
         return disp_cmp(get_object(lval), get_object(rval), ret);
-    case JSV_STRING:
-        *ret = jsstr_eq(get_string(lval), get_string(rval));
+    case JSV_STRING: {
+        jsstr_t *lstr, *rstr;
+
+        lstr = jsstr_flatten(get_string(lval));
+        rstr = jsstr_flatten(get_string(rval));
+        if(!lstr || !rstr)
+            return E_OUTOFMEMORY;
+
+        *ret = jsstr_eq(lstr, rstr);
         break;
+    }
     case JSV_NUMBER:
         *ret = get_number(lval) == get_number(rval);
         break;
@@ -495,12 +557,26 @@ static HRESULT identifier_eval(script_ctx_t *ctx, BSTR identifier, exprval_t *re
 
     TRACE("%s\n", debugstr_w(identifier));
 
-    for(scope = ctx->exec_ctx->scope_chain; scope; scope = scope->next) {
+    /* Only a hit in the first object searched may be cached, anything else could be shadowed later. */
+    scope = ctx->exec_ctx->scope_chain;
+    if(scope) {
+        if(scope->jsobj && lookup_prop_cache(ctx->exec_ctx, scope->jsobj, identifier, &id)) {
+            exprval_set_idref(ret, scope->obj, id);
+            return S_OK;
+        }
+    }else if(lookup_prop_cache(ctx->exec_ctx, ctx->global, identifier, &id)) {
+        exprval_set_idref(ret, to_disp(ctx->global), id);
+        return S_OK;
+    }
+
+    for(; scope; scope = scope->next) {
         if(scope->jsobj)
             hres = jsdisp_get_id(scope->jsobj, identifier, fdexNameImplicit, &id);
         else
             hres = disp_get_id(ctx, scope->obj, identifier, identifier, fdexNameImplicit, &id);
         if(SUCCEEDED(hres)) {
+            if(scope == ctx->exec_ctx->scope_chain && scope->jsobj)
+                update_prop_cache(ctx->exec_ctx, id);
             exprval_set_idref(ret, scope->obj, id);
             return S_OK;
         }
@@ -508,6 +584,8 @@ static HRESULT identifier_eval(script_ctx_t *ctx, BSTR identifier, exprval_t *re
 
     hres = jsdisp_get_id(ctx->global, identifier, 0, &id);
     if(SUCCEEDED(hres)) {
+        if(!ctx->exec_ctx->scope_chain)
+            update_prop_cache(ctx->exec_ctx, id);
         exprval_set_idref(ret, to_disp(ctx->global), id);
         return S_OK;
     }
@@ -855,7 +933,7 @@ static HRESULT interp_array(exec_ctx_t *ctx)
         return hres;
     }
 
-    hres = disp_get_id(ctx->script, obj, name->str, NULL, 0, &id);
+    hres = exec_get_id(ctx, obj, name->str, NULL, 0, &id);
     jsstr_release(name);
     if(SUCCEEDED(hres)) {
         hres = disp_propget(ctx->script, obj, id, &v);
@@ -885,7 +963,7 @@ static HRESULT interp_member(exec_ctx_t *ctx)
     if(FAILED(hres))
         return hres;
 
-    hres = disp_get_id(ctx->script, obj, arg, arg, 0, &id);
+    hres = exec_get_id(ctx, obj, arg, arg, 0, &id);
     if(SUCCEEDED(hres)) {
         hres = disp_propget(ctx->script, obj, id, &v);
     }else if(hres == DISP_E_UNKNOWNNAME) {
@@ -925,7 +1003,7 @@ static HRESULT interp_memberid(exec_ctx_t *ctx)
     if(FAILED(hres))
         return hres;
 
-    hres = disp_get_id(ctx->script, obj, name->str, NULL, arg, &id);
+    hres = exec_get_id(ctx, obj, name->str, NULL, arg, &id);
     jsstr_release(name);
     if(FAILED(hres)) {
         IDispatch_Release(obj);
@@ -1448,32 +1526,32 @@ static HRESULT add_eval(script_ctx_t *ctx, jsval_t lval, jsval_t rval, jsval_t *
     }
 
     if(is_string(l) || is_string(r)) {
-        jsstr_t *lstr, *rstr = NULL;
+        jsstr_t *lstr = NULL, *rstr = NULL;
 
-        hres = to_string(ctx, l, &lstr);
-        if(SUCCEEDED(hres))
-            hres = to_string(ctx, r, &rstr);
+        /* Take string operands as they are, to_string would flatten ropes. */
+        if(is_string(l))
+            lstr = jsstr_addref(get_string(l));
+        else
+            hres = to_string(ctx, l, &lstr);
+        if(SUCCEEDED(hres)) {
+            if(is_string(r))
+                rstr = jsstr_addref(get_string(r));
+            else
+                hres = to_string(ctx, r, &rstr);
+        }
 
         if(SUCCEEDED(hres)) {
-            unsigned len1, len2;
             jsstr_t *ret_str;
 
-            len1 = jsstr_length(lstr);
-            len2 = jsstr_length(rstr);
-
-            ret_str = jsstr_alloc_buf(len1+len2);
-            if(ret_str) {
-                if(len1)
-                    memcpy(ret_str->str, lstr->str, len1*sizeof(WCHAR));
-                if(len2)
-                    memcpy(ret_str->str+len1, rstr->str, len2*sizeof(WCHAR));
+            ret_str = jsstr_concat(lstr, rstr);
+            if(ret_str)
                 *ret = jsval_string(ret_str);
-            }else {
+            else
                 hres = E_OUTOFMEMORY;
-            }
         }
 
-        jsstr_release(lstr);
+        if(lstr)
+            jsstr_release(lstr);
         if(rstr)
             jsstr_release(rstr);
     }else {
@@ -2063,10 +2141,17 @@ static HRESULT less_eval(script_ctx_t *ctx, jsval_t lval, jsval_t rval, BOOL gre
     }
 
     if(is_string(l) && is_string(r)) {
-        *ret = (jsstr_cmp(get_string(l), get_string(r)) < 0) ^ greater;
-        jsstr_release(get_string(l));
-        jsstr_release(get_string(r));
-        return S_OK;
+        jsstr_t *lstr, *rstr;
+
+        lstr = jsstr_flatten(get_string(l));
+        rstr = jsstr_flatten(get_string(r));
+        if(lstr && rstr)
+            *ret = (jsstr_cmp(lstr, rstr) < 0) ^ greater;
+        else
+            hres = E_OUTOFMEMORY;
+        jsval_release(l);
+        jsval_release(r);
+        return hres;
     }
 
     hres = to_number(ctx, l, &ln);
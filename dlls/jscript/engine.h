@@ -161,10 +161,18 @@ typedef struct _function_code_t {
     BSTR *params;
 } function_code_t;
 
+#define PROP_CACHE_SIZE 64
+
+typedef struct {
+    unsigned ip;
+    DISPID id;
+} prop_cache_entry_t;
+
 typedef struct _bytecode_t {
     LONG ref;
 
     instr_t *instrs;
+    prop_cache_entry_t *prop_cache;
     jsheap_t heap;
 
     function_code_t global_code;
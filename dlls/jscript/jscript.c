@@ -72,6 +72,7 @@ void script_release(script_ctx_t *ctx)
     if(ctx->cc)
         release_cc(ctx->cc);
     jsheap_free(&ctx->tmp_heap);
+    release_regexp_cache(ctx);
     if(ctx->last_match)
         jsstr_release(ctx->last_match);
 
@@ -22,6 +22,14 @@
 
 const char *debugstr_jsstr(jsstr_t *str)
 {
+    if(jsstr_is_rope(str)) {
+        jsstr_rope_t *rope = (jsstr_rope_t*)str;
+
+        if(!rope->flat)
+            return wine_dbg_sprintf("rope(%u)", jsstr_length(str));
+        str = rope->flat;
+    }
+
     return debugstr_wn(str->str, jsstr_length(str));
 }
 
@@ -66,6 +74,177 @@ int jsstr_cmp(jsstr_t *str1, jsstr_t *str2)
     return ret;
 }
 
+/* Returns the flat contents of str, or NULL if it's a rope that wasn't flattened yet. */
+static inline jsstr_t *jsstr_get_flat(jsstr_t *str)
+{
+    return jsstr_is_rope(str) ? ((jsstr_rope_t*)str)->flat : str;
+}
+
+typedef struct {
+    jsstr_t *str;
+    WCHAR *buf;
+} extract_entry_t;
+
+/* Copies the contents of str to buf. Ropes built by repeated concatenation may be far
+ * too deep to recurse on, so they are walked with an explicit stack. Flat children are
+ * copied right away, so only nodes with two rope children take stack space. */
+static BOOL jsstr_extract(jsstr_t *str, WCHAR *buf)
+{
+    extract_entry_t local_stack[16], *stack = local_stack, *new_stack;
+    unsigned stack_size = sizeof(local_stack)/sizeof(*local_stack), depth = 0;
+    jsstr_rope_t *rope;
+    jsstr_t *flat;
+    BOOL ret = TRUE;
+
+    while(1) {
+        while(!(flat = jsstr_get_flat(str))) {
+            rope = (jsstr_rope_t*)str;
+
+            if((flat = jsstr_get_flat(rope->right))) {
+                memcpy(buf+jsstr_length(rope->left), flat->str, jsstr_length(flat)*sizeof(WCHAR));
+                str = rope->left;
+            }else if((flat = jsstr_get_flat(rope->left))) {
+                memcpy(buf, flat->str, jsstr_length(flat)*sizeof(WCHAR));
+                buf += jsstr_length(flat);
+                str = rope->right;
+            }else {
+                if(depth == stack_size) {
+                    if(stack == local_stack) {
+                        new_stack = heap_alloc(stack_size*2*sizeof(*stack));
+                        if(new_stack)
+                            memcpy(new_stack, stack, stack_size*sizeof(*stack));
+                    }else {
+                        new_stack = heap_realloc(stack, stack_size*2*sizeof(*stack));
+                    }
+                    if(!new_stack) {
+                        ret = FALSE;
+                        goto done;
+                    }
+                    stack = new_stack;
+                    stack_size *= 2;
+                }
+
+                stack[depth].str = rope->right;
+                stack[depth++].buf = buf+jsstr_length(rope->left);
+                str = rope->left;
+            }
+        }
+
+        memcpy(buf, flat->str, jsstr_length(flat)*sizeof(WCHAR));
+        if(!depth)
+            break;
+
+        depth--;
+        str = stack[depth].str;
+        buf = stack[depth].buf;
+    }
+
+done:
+    if(stack != local_stack)
+        heap_free(stack);
+    return ret;
+}
+
+jsstr_t *jsstr_flatten_rope(jsstr_t *str)
+{
+    jsstr_rope_t *rope = (jsstr_rope_t*)str;
+    jsstr_t *flat;
+
+    if(rope->flat)
+        return rope->flat;
+
+    flat = jsstr_alloc_buf(jsstr_length(str));
+    if(!flat)
+        return NULL;
+
+    if(!jsstr_extract(str, flat->str)) {
+        jsstr_release(flat);
+        return NULL;
+    }
+
+    jsstr_release(rope->left);
+    jsstr_release(rope->right);
+    rope->left = rope->right = NULL;
+    rope->flat = flat;
+    return flat;
+}
+
+/* Drops a reference to a child of a rope being freed. Child ropes that are no longer
+ * referenced are pushed to the stack, linked through their flat field. */
+static void jsstr_release_child(jsstr_t *str, jsstr_rope_t **stack)
+{
+    jsstr_rope_t *rope;
+
+    if(!str || --str->ref)
+        return;
+
+    if(!jsstr_is_rope(str)) {
+        heap_free(str);
+        return;
+    }
+
+    rope = (jsstr_rope_t*)str;
+    if(rope->flat)
+        jsstr_release(rope->flat);
+    rope->flat = (jsstr_t*)*stack;
+    *stack = rope;
+}
+
+/* Frees a rope and all its children that are no longer referenced, without recursion. */
+void jsstr_free_rope(jsstr_t *str)
+{
+    jsstr_rope_t *rope, *stack = (jsstr_rope_t*)str;
+
+    if(stack->flat)
+        jsstr_release(stack->flat);
+    stack->flat = NULL;
+
+    while(stack) {
+        rope = stack;
+        stack = (jsstr_rope_t*)rope->flat;
+
+        jsstr_release_child(rope->left, &stack);
+        jsstr_release_child(rope->right, &stack);
+        heap_free(rope);
+    }
+}
+
+/* Returns a new string containing str1 followed by str2. Both may be ropes. */
+jsstr_t *jsstr_concat(jsstr_t *str1, jsstr_t *str2)
+{
+    unsigned len1, len2;
+    jsstr_rope_t *rope;
+    jsstr_t *ret;
+
+    len1 = jsstr_length(str1);
+    len2 = jsstr_length(str2);
+    if(len1+len2 > JSSTR_MAX_LENGTH)
+        return NULL;
+
+    if(len1+len2 < JSSTR_ROPE_MIN_LENGTH) {
+        ret = jsstr_alloc_buf(len1+len2);
+        if(!ret)
+            return NULL;
+
+        if(!jsstr_extract(str1, ret->str) || !jsstr_extract(str2, ret->str+len1)) {
+            jsstr_release(ret);
+            return NULL;
+        }
+        return ret;
+    }
+
+    rope = heap_alloc(sizeof(*rope));
+    if(!rope)
+        return NULL;
+
+    rope->length_flags = ((len1+len2) << JSSTR_LENGTH_SHIFT) | JSSTR_FLAG_ROPE;
+    rope->ref = 1;
+    rope->left = jsstr_addref(str1);
+    rope->right = jsstr_addref(str2);
+    rope->flat = NULL;
+    return (jsstr_t*)rope;
+}
+
 static jsstr_t *empty_str, *nan_str;
 
 jsstr_t *jsstr_nan(void)
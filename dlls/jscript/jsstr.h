@@ -27,12 +27,35 @@ struct _jsstr_t {
 #define JSSTR_FLAGS_MASK ((1 << JSSTR_LENGTH_SHIFT)-1)
 
 #define JSSTR_FLAG_NULLBSTR 1
+#define JSSTR_FLAG_ROPE     2
+
+/*
+ * Ropes are lazy concatenations created by the '+' operator. They may only be
+ * stored in jsval_t values and must be flattened by jsstr_flatten before their
+ * contents are accessed. Once flattened, a rope keeps a reference to the flat
+ * string and drops its children.
+ */
+typedef struct {
+    unsigned length_flags;
+    unsigned ref;
+    jsstr_t *left;
+    jsstr_t *right;
+    jsstr_t *flat;
+} jsstr_rope_t;
+
+/* Shorter concatenations are simply copied. */
+#define JSSTR_ROPE_MIN_LENGTH 256
 
 static inline unsigned jsstr_length(jsstr_t *str)
 {
     return str->length_flags >> JSSTR_LENGTH_SHIFT;
 }
 
+static inline BOOL jsstr_is_rope(jsstr_t *str)
+{
+    return (str->length_flags & JSSTR_FLAG_ROPE) != 0;
+}
+
 jsstr_t *jsstr_alloc_len(const WCHAR*,unsigned) DECLSPEC_HIDDEN;
 jsstr_t *jsstr_alloc_buf(unsigned) DECLSPEC_HIDDEN;
 
@@ -41,10 +64,16 @@ static inline jsstr_t *jsstr_alloc(const WCHAR *str)
     return jsstr_alloc_len(str, strlenW(str));
 }
 
+void jsstr_free_rope(jsstr_t*) DECLSPEC_HIDDEN;
+
 static inline void jsstr_release(jsstr_t *str)
 {
-    if(!--str->ref)
-        heap_free(str);
+    if(!--str->ref) {
+        if(jsstr_is_rope(str))
+            jsstr_free_rope(str);
+        else
+            heap_free(str);
+    }
 }
 
 static inline jsstr_t *jsstr_addref(jsstr_t *str)
@@ -61,6 +90,15 @@ static inline BOOL jsstr_eq(jsstr_t *str1, jsstr_t *str2)
 
 int jsstr_cmp(jsstr_t*,jsstr_t*) DECLSPEC_HIDDEN;
 
+jsstr_t *jsstr_concat(jsstr_t*,jsstr_t*) DECLSPEC_HIDDEN;
+jsstr_t *jsstr_flatten_rope(jsstr_t*) DECLSPEC_HIDDEN;
+
+/* Returns a flat string with the contents of str, or NULL on failure. No reference is added. */
+static inline jsstr_t *jsstr_flatten(jsstr_t *str)
+{
+    return jsstr_is_rope(str) ? jsstr_flatten_rope(str) : str;
+}
+
 jsstr_t *jsstr_nan(void) DECLSPEC_HIDDEN;
 jsstr_t *jsstr_empty(void) DECLSPEC_HIDDEN;
 
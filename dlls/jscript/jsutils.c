@@ -348,7 +348,10 @@ HRESULT jsval_to_variant(jsval_t val, VARIANT *retv)
         V_DISPATCH(retv) = get_object(val);
         return S_OK;
     case JSV_STRING: {
-        jsstr_t *str = get_string(val);
+        jsstr_t *str = jsstr_flatten(get_string(val));
+
+        if(!str)
+            return E_OUTOFMEMORY;
 
         V_VT(retv) = VT_BSTR;
         if(str->length_flags & JSSTR_FLAG_NULLBSTR) {
@@ -605,8 +608,13 @@ HRESULT to_number(script_ctx_t *ctx, jsval_t val, double *ret)
     case JSV_NUMBER:
         *ret = get_number(val);
         return S_OK;
-    case JSV_STRING:
-        return str_to_number(get_string(val), ret);
+    case JSV_STRING: {
+        jsstr_t *str = jsstr_flatten(get_string(val));
+
+        if(!str)
+            return E_OUTOFMEMORY;
+        return str_to_number(str, ret);
+    }
     case JSV_OBJECT: {
         jsval_t prim;
         HRESULT hres;
@@ -753,7 +761,9 @@ HRESULT to_string(script_ctx_t *ctx, jsval_t val, jsstr_t **str)
     case JSV_NUMBER:
         return double_to_string(get_number(val), str);
     case JSV_STRING:
-        *str = jsstr_addref(get_string(val));
+        *str = jsstr_flatten(get_string(val));
+        if(*str)
+            jsstr_addref(*str);
         break;
     case JSV_OBJECT: {
         jsval_t prim;
@@ -785,13 +795,19 @@ HRESULT to_object(script_ctx_t *ctx, jsval_t val, IDispatch **disp)
     HRESULT hres;
 
     switch(jsval_type(val)) {
-    case JSV_STRING:
-        hres = create_string(ctx, get_string(val), &dispex);
+    case JSV_STRING: {
+        jsstr_t *str = jsstr_flatten(get_string(val));
+
+        if(!str)
+            return E_OUTOFMEMORY;
+
+        hres = create_string(ctx, str, &dispex);
         if(FAILED(hres))
             return hres;
 
         *disp = to_disp(dispex);
         break;
+    }
     case JSV_NUMBER:
         hres = create_number(ctx, get_number(val), &dispex);
         if(FAILED(hres))
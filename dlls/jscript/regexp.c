@@ -69,15 +69,29 @@ typedef struct RECharSet {
     } u;
 } RECharSet;
 
+#define FIRSTCHAR_NONE  0
+#define FIRSTCHAR_EXACT 1
+#define FIRSTCHAR_FOLD  2
+
 typedef struct {
+    LONG         ref;
     WORD         flags;         /* flags, see jsapi.h's JSREG_* defines */
     size_t       parenCount;    /* number of parenthesized submatches */
     size_t       classCount;    /* count [...] bitmaps */
     RECharSet    *classList;    /* list of [...] bitmaps */
     jsstr_t      *source;       /* locked source string, sans // */
+    WCHAR        firstChar;     /* character every match has to start with */
+    BYTE         firstCharType; /* FIRSTCHAR_* value describing firstChar */
     jsbytecode   program[1];    /* regular expression bytecode */
 } JSRegExp;
 
+#define REGEXP_CACHE_SIZE 32
+
+/* Recently compiled regexps, so that evaluating the same literal again doesn't recompile it. */
+struct _regexp_cache_t {
+    JSRegExp *entries[REGEXP_CACHE_SIZE];
+};
+
 typedef struct {
     jsdisp_t dispex;
 
@@ -2591,6 +2605,32 @@ SimpleMatch(REGlobalData *gData, REMatchState *x, REOp op,
     return NULL;
 }
 
+/*
+ * Returns the first position at or after cp where a match may start, or NULL
+ * if there is none. Must only be used if firstCharType is not FIRSTCHAR_NONE.
+ */
+static const WCHAR *
+FindMatchStart(REGlobalData *gData, const WCHAR *cp)
+{
+    JSRegExp *re = gData->regexp;
+    WCHAR ch = re->firstChar;
+
+    if (re->firstCharType == FIRSTCHAR_EXACT) {
+        for (; cp < gData->cpend; cp++) {
+            if (*cp == ch)
+                return cp;
+        }
+    } else {
+        ch = toupperW(ch);
+        for (; cp < gData->cpend; cp++) {
+            if (toupperW(*cp) == ch)
+                return cp;
+        }
+    }
+
+    return NULL;
+}
+
 static inline REMatchState *
 ExecuteREBytecode(REGlobalData *gData, REMatchState *x)
 {
@@ -2618,6 +2658,13 @@ ExecuteREBytecode(REGlobalData *gData, REMatchState *x)
     if (REOP_IS_SIMPLE(op) && !(gData->regexp->flags & JSREG_STICKY)) {
         anchor = FALSE;
         while (x->cp <= gData->cpend) {
+            if (gData->regexp->firstCharType != FIRSTCHAR_NONE) {
+                startcp = FindMatchStart(gData, x->cp);
+                if (!startcp)
+                    break;
+                gData->skipped += startcp - x->cp;
+                x->cp = startcp;
+            }
             nextpc = pc;    /* reset back to start each time */
             result = SimpleMatch(gData, x, op, &nextpc, TRUE);
             if (result) {
@@ -3141,6 +3188,12 @@ static REMatchState *MatchRegExp(REGlobalData *gData, REMatchState *x)
      * in order to detect end-of-input/line condition.
      */
     for (cp2 = cp; cp2 <= gData->cpend; cp2++) {
+        if (gData->regexp->firstCharType != FIRSTCHAR_NONE
+                && !(gData->regexp->flags & JSREG_STICKY)) {
+            cp2 = FindMatchStart(gData, cp2);
+            if (!cp2)
+                return NULL;
+        }
         gData->skipped = cp2 - cp;
         x->cp = cp2;
         for (j = 0; j < gData->regexp->parenCount; j++)
@@ -3214,9 +3267,57 @@ js_DestroyRegExp(JSRegExp *re)
         }
         heap_free(re->classList);
     }
+    if (re->source)
+        jsstr_release(re->source);
     heap_free(re);
 }
 
+static void
+js_ReleaseRegExp(JSRegExp *re)
+{
+    if (!--re->ref)
+        js_DestroyRegExp(re);
+}
+
+/*
+ * Find the character every match has to start with, if any. Opening parens
+ * don't consume input, so they are skipped.
+ */
+static void
+FindFirstChar(JSRegExp *re)
+{
+    jsbytecode *pc = re->program;
+    size_t index;
+
+    re->firstCharType = FIRSTCHAR_NONE;
+
+    while (*pc == REOP_LPAREN)
+        pc = ReadCompactIndex(pc + 1, &index);
+
+    switch (*pc) {
+      case REOP_FLAT:
+      case REOP_FLATi:
+        ReadCompactIndex(pc + 1, &index);
+        re->firstChar = re->source->str[index];
+        break;
+      case REOP_FLAT1:
+      case REOP_FLAT1i:
+        re->firstChar = pc[1];
+        break;
+      case REOP_UCFLAT1:
+      case REOP_UCFLAT1i:
+        re->firstChar = GET_ARG(pc + 1);
+        break;
+      default:
+        return;
+    }
+
+    if (*pc == REOP_FLATi || *pc == REOP_FLAT1i || *pc == REOP_UCFLAT1i)
+        re->firstCharType = FIRSTCHAR_FOLD;
+    else
+        re->firstCharType = FIRSTCHAR_EXACT;
+}
+
 static JSRegExp *
 js_NewRegExp(script_ctx_t *cx, jsstr_t *str, UINT flags, BOOL flat)
 {
@@ -3266,6 +3367,7 @@ js_NewRegExp(script_ctx_t *cx, jsstr_t *str, UINT flags, BOOL flat)
     if (!re)
         goto out;
 
+    re->source = NULL;
     assert(state.classBitmapsMem <= CLASS_BITMAPS_MEM_LIMIT);
     re->classCount = state.classCount;
     if (re->classCount) {
@@ -3301,9 +3403,11 @@ js_NewRegExp(script_ctx_t *cx, jsstr_t *str, UINT flags, BOOL flat)
             re = tmp;
     }
 
+    re->ref = 1;
     re->flags = flags;
     re->parenCount = state.parenCount;
-    re->source = str;
+    re->source = jsstr_addref(str);
+    FindFirstChar(re);
 
 out:
     jsheap_clear(mark);
@@ -3776,7 +3880,7 @@ static void RegExp_destructor(jsdisp_t *dispex)
     RegExpInstance *This = (RegExpInstance*)dispex;
 
     if(This->jsregexp)
-        js_DestroyRegExp(This->jsregexp);
+        js_ReleaseRegExp(This->jsregexp);
     jsval_release(This->last_index_val);
     jsstr_release(This->str);
     heap_free(This);
@@ -3842,6 +3946,53 @@ static HRESULT alloc_regexp(script_ctx_t *ctx, jsdisp_t *object_prototype, RegEx
     return S_OK;
 }
 
+static JSRegExp *get_cached_regexp(script_ctx_t *ctx, jsstr_t *src, DWORD flags)
+{
+    JSRegExp **entry, *re;
+    unsigned hash = flags, i;
+
+    if(!ctx->regexp_cache) {
+        ctx->regexp_cache = heap_alloc_zero(sizeof(*ctx->regexp_cache));
+        if(!ctx->regexp_cache)
+            return js_NewRegExp(ctx, src, flags, FALSE);
+    }
+
+    for(i=0; i < jsstr_length(src); i++)
+        hash = hash*31 + src->str[i];
+    entry = ctx->regexp_cache->entries + hash % REGEXP_CACHE_SIZE;
+
+    re = *entry;
+    if(re && re->flags == flags && jsstr_eq(re->source, src)) {
+        re->ref++;
+        return re;
+    }
+
+    re = js_NewRegExp(ctx, src, flags, FALSE);
+    if(!re)
+        return NULL;
+
+    if(*entry)
+        js_ReleaseRegExp(*entry);
+    re->ref++;
+    *entry = re;
+    return re;
+}
+
+void release_regexp_cache(script_ctx_t *ctx)
+{
+    unsigned i;
+
+    if(!ctx->regexp_cache)
+        return;
+
+    for(i=0; i < REGEXP_CACHE_SIZE; i++) {
+        if(ctx->regexp_cache->entries[i])
+            js_ReleaseRegExp(ctx->regexp_cache->entries[i]);
+    }
+    heap_free(ctx->regexp_cache);
+    ctx->regexp_cache = NULL;
+}
+
 HRESULT create_regexp(script_ctx_t *ctx, jsstr_t *src, DWORD flags, jsdisp_t **ret)
 {
     RegExpInstance *regexp;
@@ -3856,7 +4007,7 @@ HRESULT create_regexp(script_ctx_t *ctx, jsstr_t *src, DWORD flags, jsdisp_t **r
     regexp->str = jsstr_addref(src);
     regexp->last_index_val = jsval_number(0);
 
-    regexp->jsregexp = js_NewRegExp(ctx, regexp->str, flags, FALSE);
+    regexp->jsregexp = get_cached_regexp(ctx, regexp->str, flags);
     if(!regexp->jsregexp) {
         WARN("js_NewRegExp failed\n");
         jsdisp_release(&regexp->dispex);
@@ -3895,7 +4046,9 @@ HRESULT create_regexp_var(script_ctx_t *ctx, jsval_t src_arg, jsval_t *flags_arg
         return E_NOTIMPL;
     }
 
-    src = get_string(src_arg);
+    src = jsstr_flatten(get_string(src_arg));
+    if(!src)
+        return E_OUTOFMEMORY;
 
     if(flags_arg) {
         if(!is_string(*flags_arg)) {
@@ -3903,7 +4056,9 @@ HRESULT create_regexp_var(script_ctx_t *ctx, jsval_t src_arg, jsval_t *flags_arg
             return E_NOTIMPL;
         }
 
-        opt = get_string(*flags_arg);
+        opt = jsstr_flatten(get_string(*flags_arg));
+        if(!opt)
+            return E_OUTOFMEMORY;
     }
 
     hres = parse_regexp_flags(opt ? opt->str : NULL, opt ? jsstr_length(opt) : 0, &flags);
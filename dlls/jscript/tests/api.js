@@ -878,6 +878,30 @@ tmp = arr.pop();
 ok(arr.length === 5, "arr.length = " + arr.length);
 ok(tmp === undefined, "tmp = " + tmp);
 
+arr = [];
+for(i = 0; i < 1000; i++)
+    arr.push(i);
+ok(arr.length === 1000, "arr.length = " + arr.length);
+ok(arr[999] === 999, "arr[999] = " + arr[999]);
+ok(arr["10"] === 10, "arr[\"10\"] = " + arr["10"]);
+ok(arr["010"] === undefined, "arr[\"010\"] = " + arr["010"]);
+arr.reverse();
+ok(arr[0] === 999 && arr[999] === 0, "reversed arr = " + arr[0] + "," + arr[999]);
+arr.sort(function(a, b) { return a - b; });
+ok(arr[0] === 0 && arr[500] === 500, "sorted arr = " + arr[0] + "," + arr[500]);
+tmp = arr.splice(10, 980);
+ok(arr.length === 20, "arr.length = " + arr.length);
+ok(arr[10] === 990, "arr[10] = " + arr[10]);
+ok(tmp.length === 980 && tmp[979] === 989, "splice() = " + tmp.length + "," + tmp[979]);
+delete arr[5];
+ok(arr[5] === undefined, "arr[5] = " + arr[5]);
+arr[5] = "x";
+ok(arr[5] === "x", "arr[5] = " + arr[5]);
+arr[100000] = 1;
+ok(arr.length === 100001, "arr.length = " + arr.length);
+ok(arr.pop() === 1, "arr.pop() != 1");
+ok(arr.length === 100000, "arr.length = " + arr.length);
+
 function PseudoArray() {
     this[0] = 0;
 }
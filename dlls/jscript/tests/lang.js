@@ -1425,6 +1425,63 @@ function returnTest() {
 
 ok(returnTest() === undefined, "returnTest = " + returnTest());
 
+function testCachedLookups() {
+    var i, r = "", o = {a: 1, b: 2}, x = "global";
+
+    for(i = 0; i < 3; i++) {
+        r += o.a;
+        if(i == 0)
+            delete o.a;
+        else if(i == 1)
+            o.a = 3;
+    }
+    ok(r === "1undefined3", "r = " + r);
+
+    function f() {
+        var s = "";
+        for(var j = 0; j < 2; j++)
+            s += x;
+        return s;
+    }
+    ok(f() === "globalglobal", "f() = " + f());
+    x = "changed";
+    ok(f() === "changedchanged", "f() = " + f());
+}
+
+testCachedLookups();
+
+function testLongConcat() {
+    var i, s = "", t = "";
+
+    for(i = 0; i < 1000; i++)
+        s += "ab";
+    ok(s.length === 2000, "s.length = " + s.length);
+    ok(s.charAt(1999) === "b", "s.charAt(1999) = " + s.charAt(1999));
+    ok(s.indexOf("ba") === 1, "s.indexOf(\"ba\") = " + s.indexOf("ba"));
+
+    for(i = 0; i < 2000; i += 2)
+        t = t + "a" + "b";
+    ok(s === t, "s !== t");
+    ok(!(s < t) && !(s > t), "s and t compare unequal");
+    ok(s + "c" > t, "s + \"c\" <= t");
+
+    t = "x" + s;
+    ok(t.length === 2001, "t.length = " + t.length);
+    ok(t.substr(0, 3) === "xab", "t.substr(0, 3) = " + t.substr(0, 3));
+    ok(eval("'" + s + "'") === s, "eval of long string failed");
+
+    /* deep right-leaning rope */
+    t = s;
+    for(i = 0; i < 100000; i++)
+        t = "x" + t;
+    ok(t.length === 102000, "t.length = " + t.length);
+    ok(t.charAt(99999) === "x", "t.charAt(99999) = " + t.charAt(99999));
+    ok(t.substr(100000, 2) === "ab", "t.substr(100000, 2) = " + t.substr(100000, 2));
+    t = "";
+}
+
+testLongConcat();
+
 /* Keep this test in the end of file */
 undefined = 6;
 ok(undefined === 6, "undefined = " + undefined);
@@ -648,4 +648,29 @@ ok(!("$10" in RegExp), "RegExp.$10 exists");
 RegExp.$1 = "a";
 ok(RegExp.$1 === "b", "RegExp.$1 = " + RegExp.$1);
 
+for(i = 0; i < 3; i++) {
+    re = /xy/g;
+    ok(re.lastIndex === 0, "re.lastIndex = " + re.lastIndex);
+    m = re.exec("axyxy");
+    ok(m.index === 1, "m.index = " + m.index);
+    ok(re.lastIndex === 3, "re.lastIndex = " + re.lastIndex);
+    m = re.exec("axyxy");
+    ok(m.index === 3, "m.index = " + m.index);
+}
+
+ok(/xy/i.test("aXY"), "/xy/i.test(\"aXY\") returned false");
+ok(!/xy/.test("aXY"), "/xy/.test(\"aXY\") returned true");
+ok(/X/i.test("x"), "/X/i.test(\"x\") returned false");
+ok(/xz/.test("xxyxz"), "/xz/.test(\"xxyxz\") returned false");
+ok(!/xz/.test("xxyx"), "/xz/.test(\"xxyx\") returned true");
+
+m = /((a)b)c/.exec("ababc");
+ok(m.index === 2, "m.index = " + m.index);
+ok(m[1] === "ab", "m[1] = " + m[1]);
+ok(m[2] === "a", "m[2] = " + m[2]);
+
+m = /(a)|b/.exec("cb");
+ok(m.index === 1, "m.index = " + m.index);
+ok(m[0] === "b", "m[0] = " + m[0]);
+
 reportSuccess();
@@ -61,6 +61,21 @@ typedef struct tagPROFILESECTION
 } PROFILESECTION;
 
 
+/* hash table entry for a section (key == NULL) or a key of a section */
+typedef struct tagPROFILEHASHENTRY
+{
+    struct tagPROFILEHASHENTRY *next;
+    PROFILESECTION             *section;
+    PROFILEKEY                 *key;
+} PROFILEHASHENTRY;
+
+typedef struct
+{
+    UINT               size;
+    PROFILEHASHENTRY **buckets;
+    PROFILEHASHENTRY   entries[1];
+} PROFILEINDEX;
+
 typedef struct
 {
     BOOL             changed;
@@ -68,6 +83,7 @@ typedef struct
     WCHAR           *filename;
     FILETIME LastWriteTime;
     ENCODING encoding;
+    PROFILEINDEX    *index;     /* lookup index, rebuilt after the tree changes */
 } PROFILE;
 
 
@@ -491,6 +507,131 @@ static PROFILESECTION *PROFILE_Load(HANDLE hFile, ENCODING * pEncoding)
 }
 
 
+/***********************************************************************
+ *           PROFILE_HashName
+ *
+ * Case-insensitive hash of a section or key name. Keys are hashed
+ * together with the section they belong to.
+ */
+static UINT PROFILE_HashName( LPCWSTR name, int len, const PROFILESECTION *section, UINT size )
+{
+    UINT hash = (UINT)(ULONG_PTR)section;
+
+    while (len-- && *name) hash = hash * 31 + tolowerW( *name++ );
+    return hash % size;
+}
+
+
+/***********************************************************************
+ *           PROFILE_FreeIndex
+ *
+ * Discard the lookup index of a profile after its tree was modified.
+ */
+static void PROFILE_FreeIndex( PROFILE *profile )
+{
+    HeapFree( GetProcessHeap(), 0, profile->index );
+    profile->index = NULL;
+}
+
+
+/***********************************************************************
+ *           PROFILE_GetIndex
+ *
+ * Build the lookup index of a profile if needed.
+ */
+static PROFILEINDEX *PROFILE_GetIndex( PROFILE *profile )
+{
+    PROFILEINDEX *index;
+    PROFILESECTION *section;
+    PROFILEKEY *key;
+    PROFILEHASHENTRY *entry;
+    UINT count = 0, i;
+
+    if (profile->index) return profile->index;
+
+    for (section = profile->section; section; section = section->next)
+    {
+        if (!section->name[0]) continue;
+        count++;
+        for (key = section->key; key; key = key->next) count++;
+    }
+
+    index = HeapAlloc( GetProcessHeap(), HEAP_ZERO_MEMORY,
+                       FIELD_OFFSET( PROFILEINDEX, entries[count + 1] ) +
+                       (count + 1) * sizeof(*index->buckets) );
+    if (!index) return NULL;
+    index->size = count + 1;
+    index->buckets = (PROFILEHASHENTRY **)&index->entries[count + 1];
+
+    entry = index->entries;
+    for (section = profile->section; section; section = section->next)
+    {
+        if (!section->name[0]) continue;
+        entry->section = section;
+        entry++;
+        for (key = section->key; key; key = key->next)
+        {
+            entry->section = section;
+            entry->key = key;
+            entry++;
+        }
+    }
+
+    /* insert in reverse order so that the first occurrence of a
+     * duplicated name is found first, as in the linked lists */
+    for (i = count; i > 0; i--)
+    {
+        PROFILEHASHENTRY **bucket;
+
+        entry = &index->entries[i - 1];
+        if (entry->key)
+            bucket = &index->buckets[PROFILE_HashName( entry->key->name, strlenW(entry->key->name),
+                                                       entry->section, index->size )];
+        else
+            bucket = &index->buckets[PROFILE_HashName( entry->section->name, strlenW(entry->section->name),
+                                                       NULL, index->size )];
+        entry->next = *bucket;
+        *bucket = entry;
+    }
+    profile->index = index;
+    return index;
+}
+
+
+/***********************************************************************
+ *           PROFILE_FindInIndex
+ *
+ * Find a key through the lookup index. The names must already be trimmed.
+ */
+static PROFILEKEY *PROFILE_FindInIndex( const PROFILEINDEX *index, LPCWSTR section_name, int seclen,
+                                        LPCWSTR key_name, int keylen )
+{
+    const PROFILEHASHENTRY *entry;
+    PROFILESECTION *section = NULL;
+
+    for (entry = index->buckets[PROFILE_HashName( section_name, seclen, NULL, index->size )];
+         entry; entry = entry->next)
+    {
+        if (!entry->key && !strncmpiW( entry->section->name, section_name, seclen ) &&
+            !entry->section->name[seclen])
+        {
+            section = entry->section;
+            break;
+        }
+    }
+    if (!section) return NULL;
+
+    for (entry = index->buckets[PROFILE_HashName( key_name, keylen, section, index->size )];
+         entry; entry = entry->next)
+    {
+        if (entry->key && entry->section == section &&
+            !strncmpiW( entry->key->name, key_name, keylen ) && !entry->key->name[keylen])
+            return entry->key;
+    }
+    return NULL;
+}
+
+
 /***********************************************************************
  *           PROFILE_DeleteSection
  *
@@ -566,6 +707,7 @@ static void PROFILE_DeleteAllKeys( LPCWSTR section_name)
                 HeapFree( GetProcessHeap(), 0, to_del->value);
 		HeapFree( GetProcessHeap(), 0, to_del );
 		CurProfile->changed =TRUE;
+                PROFILE_FreeIndex( CurProfile );
             }
         }
         section = &(*section)->next;
@@ -581,6 +723,7 @@ static void PROFILE_DeleteAllKeys( LPCWSTR section_name)
 static PROFILEKEY *PROFILE_Find( PROFILESECTION **section, LPCWSTR section_name,
                                  LPCWSTR key_name, BOOL create, BOOL create_always )
 {
+    PROFILEINDEX *index;
     LPCWSTR p;
     int seclen, keylen;
 
@@ -602,6 +745,13 @@ static PROFILEKEY *PROFILE_Find( PROFILESECTION **section, LPCWSTR section_name,
     while ((p > key_name) && PROFILE_isspaceW(*p)) p--;
     keylen = p - key_name + 1;
 
+    /* creating a key goes through the lists below */
+    if (!create_always && (index = PROFILE_GetIndex( CurProfile )))
+    {
+        PROFILEKEY *key = PROFILE_FindInIndex( index, section_name, seclen, key_name, keylen );
+        if (key || !create) return key;
+    }
+
     while (*section)
     {
         if ( ((*section)->name[0])
@@ -628,6 +778,7 @@ static PROFILEKEY *PROFILE_Find( PROFILESECTION **section, LPCWSTR section_name,
             if (!create) return NULL;
             if (!(*key = HeapAlloc( GetProcessHeap(), 0, sizeof(PROFILEKEY) + strlenW(key_name) * sizeof(WCHAR) )))
                 return NULL;
+            PROFILE_FreeIndex( CurProfile );
             strcpyW( (*key)->name, key_name );
             (*key)->value = NULL;
             (*key)->next  = NULL;
@@ -638,6 +789,7 @@ static PROFILEKEY *PROFILE_Find( PROFILESECTION **section, LPCWSTR section_name,
     if (!create) return NULL;
     *section = HeapAlloc( GetProcessHeap(), 0, sizeof(PROFILESECTION) + strlenW(section_name) * sizeof(WCHAR) );
     if(*section == NULL) return NULL;
+    PROFILE_FreeIndex( CurProfile );
     strcpyW( (*section)->name, section_name );
     (*section)->next = NULL;
     if (!((*section)->key  = HeapAlloc( GetProcessHeap(), 0,
@@ -699,6 +851,7 @@ static void PROFILE_ReleaseFile(void)
 {
     PROFILE_FlushFile();
     PROFILE_Free( CurProfile->section );
+    PROFILE_FreeIndex( CurProfile );
     HeapFree( GetProcessHeap(), 0, CurProfile->filename );
     CurProfile->changed = FALSE;
     CurProfile->section = NULL;
@@ -753,6 +906,7 @@ static BOOL PROFILE_Open( LPCWSTR filename, BOOL write_access )
           MRUProfile[i]->section=NULL;
           MRUProfile[i]->filename=NULL;
           MRUProfile[i]->encoding=ENCODING_ANSI;
+          MRUProfile[i]->index=NULL;
           ZeroMemory(&MRUProfile[i]->LastWriteTime, sizeof(FILETIME));
        }
 
@@ -813,6 +967,7 @@ static BOOL PROFILE_Open( LPCWSTR filename, BOOL write_access )
                     TRACE("(%s): already opened, needs refreshing (mru=%d)\n",
                           debugstr_w(buffer), i);
                     PROFILE_Free(CurProfile->section);
+                    PROFILE_FreeIndex(CurProfile);
                     CurProfile->section = PROFILE_Load(hFile, &CurProfile->encoding);
                     CurProfile->LastWriteTime = LastWriteTime;
                 }
@@ -1030,6 +1185,7 @@ static BOOL PROFILE_SetString( LPCWSTR section_name, LPCWSTR key_name,
         TRACE("(%s)\n", debugstr_w(section_name));
         CurProfile->changed |= PROFILE_DeleteSection( &CurProfile->section,
                                                       section_name );
+        PROFILE_FreeIndex( CurProfile );
         return TRUE;         /* Even if PROFILE_DeleteSection() has failed,
                                 this is not an error on application's level.*/
     }
@@ -1038,6 +1194,7 @@ static BOOL PROFILE_SetString( LPCWSTR section_name, LPCWSTR key_name,
         TRACE("(%s,%s)\n", debugstr_w(section_name), debugstr_w(key_name) );
         CurProfile->changed |= PROFILE_DeleteKey( &CurProfile->section,
                                                   section_name, key_name );
+        PROFILE_FreeIndex( CurProfile );
         return TRUE;          /* same error handling as above */
     }
     else  /* Set the key value */
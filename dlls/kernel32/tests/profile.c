@@ -509,6 +509,56 @@ static void test_profile_refresh(void)
         "Got %d instead of 421\n", res);
 }
 
+static void test_profile_lookup(void)
+{
+    static const char testfile[] = ".\\winetest5.ini";
+    static const char contents[] = "[Section1]\r\nKey1=val1\r\nkey2=val2\r\n"
+                                   "[section2]\r\nkey1=val3\r\n";
+    char buf[MAX_PATH];
+    HANDLE h;
+    DWORD size, res;
+
+    h = CreateFile(testfile, GENERIC_WRITE, 0, NULL, CREATE_ALWAYS, FILE_ATTRIBUTE_NORMAL, NULL);
+    ok( h != INVALID_HANDLE_VALUE, "cannot create %s\n", testfile );
+    if (h == INVALID_HANDLE_VALUE) return;
+    res = WriteFile( h, contents, sizeof contents - 1, &size, NULL );
+    ok( res, "Cannot write test file: %x\n", GetLastError() );
+    CloseHandle(h);
+
+    /* section and key names are case insensitive, and keys belong to their section */
+    res = GetPrivateProfileStringA("SECTION1", "KEY1", "def", buf, sizeof(buf), testfile);
+    ok( res == 4 && !strcmp(buf, "val1"), "got %d %s\n", res, buf );
+    res = GetPrivateProfileStringA("section2", "Key1", "def", buf, sizeof(buf), testfile);
+    ok( res == 4 && !strcmp(buf, "val3"), "got %d %s\n", res, buf );
+    res = GetPrivateProfileStringA("section2", "key2", "def", buf, sizeof(buf), testfile);
+    ok( res == 3 && !strcmp(buf, "def"), "got %d %s\n", res, buf );
+    res = GetPrivateProfileStringA("  section1  ", "  key2  ", "def", buf, sizeof(buf), testfile);
+    ok( res == 4 && !strcmp(buf, "val2"), "got %d %s\n", res, buf );
+
+    /* lookups must see keys and sections added or removed in between */
+    res = WritePrivateProfileStringA("section2", "key2", "val4", testfile);
+    ok( res, "WritePrivateProfileString failed: %u\n", GetLastError() );
+    res = GetPrivateProfileStringA("section2", "key2", "def", buf, sizeof(buf), testfile);
+    ok( res == 4 && !strcmp(buf, "val4"), "got %d %s\n", res, buf );
+
+    res = WritePrivateProfileStringA("section3", "key1", "val5", testfile);
+    ok( res, "WritePrivateProfileString failed: %u\n", GetLastError() );
+    res = GetPrivateProfileStringA("Section3", "key1", "def", buf, sizeof(buf), testfile);
+    ok( res == 4 && !strcmp(buf, "val5"), "got %d %s\n", res, buf );
+
+    res = WritePrivateProfileStringA("section1", "key1", NULL, testfile);
+    ok( res, "WritePrivateProfileString failed: %u\n", GetLastError() );
+    res = GetPrivateProfileStringA("section1", "key1", "def", buf, sizeof(buf), testfile);
+    ok( res == 3 && !strcmp(buf, "def"), "got %d %s\n", res, buf );
+
+    res = WritePrivateProfileStringA("section2", NULL, NULL, testfile);
+    ok( res, "WritePrivateProfileString failed: %u\n", GetLastError() );
+    res = GetPrivateProfileStringA("section2", "key1", "def", buf, sizeof(buf), testfile);
+    ok( res == 3 && !strcmp(buf, "def"), "got %d %s\n", res, buf );
+
+    DeleteFileA(testfile);
+}
+
 static void create_test_file(LPCSTR name, LPCSTR data, DWORD size)
 {
     HANDLE hfile;
@@ -1128,6 +1178,7 @@ START_TEST(profile)
     test_profile_existing();
     test_profile_delete_on_close();
     test_profile_refresh();
+    test_profile_lookup();
     test_GetPrivateProfileString(
         "[section1]\r\n"
         "name1=val1\r\n"
@@ -447,61 +447,45 @@ static void sax_serror(void* ctx, xmlErrorPtr err)
     LIBXML2_CALLBACK_SERROR(doparse, err);
 }
 
-static xmlDocPtr doparse(domdoc* This, char const* ptr, int len, xmlCharEncoding encoding)
+static xmlSAXHandler sax_handler = {
+    xmlSAX2InternalSubset,          /* internalSubset */
+    xmlSAX2IsStandalone,            /* isStandalone */
+    xmlSAX2HasInternalSubset,       /* hasInternalSubset */
+    xmlSAX2HasExternalSubset,       /* hasExternalSubset */
+    xmlSAX2ResolveEntity,           /* resolveEntity */
+    xmlSAX2GetEntity,               /* getEntity */
+    xmlSAX2EntityDecl,              /* entityDecl */
+    xmlSAX2NotationDecl,            /* notationDecl */
+    xmlSAX2AttributeDecl,           /* attributeDecl */
+    xmlSAX2ElementDecl,             /* elementDecl */
+    xmlSAX2UnparsedEntityDecl,      /* unparsedEntityDecl */
+    xmlSAX2SetDocumentLocator,      /* setDocumentLocator */
+    xmlSAX2StartDocument,           /* startDocument */
+    xmlSAX2EndDocument,             /* endDocument */
+    xmlSAX2StartElement,            /* startElement */
+    xmlSAX2EndElement,              /* endElement */
+    xmlSAX2Reference,               /* reference */
+    sax_characters,                 /* characters */
+    sax_characters,                 /* ignorableWhitespace */
+    xmlSAX2ProcessingInstruction,   /* processingInstruction */
+    xmlSAX2Comment,                 /* comment */
+    sax_warning,                    /* warning */
+    sax_error,                      /* error */
+    sax_error,                      /* fatalError */
+    xmlSAX2GetParameterEntity,      /* getParameterEntity */
+    xmlSAX2CDataBlock,              /* cdataBlock */
+    xmlSAX2ExternalSubset,          /* externalSubset */
+    0,                              /* initialized */
+    NULL,                           /* _private */
+    xmlSAX2StartElementNs,          /* startElementNs */
+    xmlSAX2EndElementNs,            /* endElementNs */
+    sax_serror                      /* serror */
+};
+
+/* Takes the document out of a parser context that has finished parsing, and frees the context. */
+static xmlDocPtr doparse_finish(xmlParserCtxtPtr pctx)
 {
     xmlDocPtr doc = NULL;
-    xmlParserCtxtPtr pctx;
-    static xmlSAXHandler sax_handler = {
-        xmlSAX2InternalSubset,          /* internalSubset */
-        xmlSAX2IsStandalone,            /* isStandalone */
-        xmlSAX2HasInternalSubset,       /* hasInternalSubset */
-        xmlSAX2HasExternalSubset,       /* hasExternalSubset */
-        xmlSAX2ResolveEntity,           /* resolveEntity */
-        xmlSAX2GetEntity,               /* getEntity */
-        xmlSAX2EntityDecl,              /* entityDecl */
-        xmlSAX2NotationDecl,            /* notationDecl */
-        xmlSAX2AttributeDecl,           /* attributeDecl */
-        xmlSAX2ElementDecl,             /* elementDecl */
-        xmlSAX2UnparsedEntityDecl,      /* unparsedEntityDecl */
-        xmlSAX2SetDocumentLocator,      /* setDocumentLocator */
-        xmlSAX2StartDocument,           /* startDocument */
-        xmlSAX2EndDocument,             /* endDocument */
-        xmlSAX2StartElement,            /* startElement */
-        xmlSAX2EndElement,              /* endElement */
-        xmlSAX2Reference,               /* reference */
-        sax_characters,                 /* characters */
-        sax_characters,                 /* ignorableWhitespace */
-        xmlSAX2ProcessingInstruction,   /* processingInstruction */
-        xmlSAX2Comment,                 /* comment */
-        sax_warning,                    /* warning */
-        sax_error,                      /* error */
-        sax_error,                      /* fatalError */
-        xmlSAX2GetParameterEntity,      /* getParameterEntity */
-        xmlSAX2CDataBlock,              /* cdataBlock */
-        xmlSAX2ExternalSubset,          /* externalSubset */
-        0,                              /* initialized */
-        NULL,                           /* _private */
-        xmlSAX2StartElementNs,          /* startElementNs */
-        xmlSAX2EndElementNs,            /* endElementNs */
-        sax_serror                      /* serror */
-    };
-
-    pctx = xmlCreateMemoryParserCtxt(ptr, len);
-    if (!pctx)
-    {
-        ERR("Failed to create parser context\n");
-        return NULL;
-    }
-
-    if (pctx->sax) xmlFree(pctx->sax);
-    pctx->sax = &sax_handler;
-    pctx->_private = This;
-    pctx->recovery = 0;
-
-    if (encoding != XML_CHAR_ENCODING_NONE)
-        xmlSwitchEncoding(pctx, encoding);
-
-    xmlParseDocument(pctx);
 
     if (pctx->wellFormed)
     {
@@ -547,6 +531,30 @@ static xmlDocPtr doparse(domdoc* This, char const* ptr, int len, xmlCharEncoding
     return doc;
 }
 
+static xmlDocPtr doparse(domdoc* This, char const* ptr, int len, xmlCharEncoding encoding)
+{
+    xmlParserCtxtPtr pctx;
+
+    pctx = xmlCreateMemoryParserCtxt(ptr, len);
+    if (!pctx)
+    {
+        ERR("Failed to create parser context\n");
+        return NULL;
+    }
+
+    if (pctx->sax) xmlFree(pctx->sax);
+    pctx->sax = &sax_handler;
+    pctx->_private = This;
+    pctx->recovery = 0;
+
+    if (encoding != XML_CHAR_ENCODING_NONE)
+        xmlSwitchEncoding(pctx, encoding);
+
+    xmlParseDocument(pctx);
+
+    return doparse_finish(pctx);
+}
+
 void xmldoc_init(xmlDocPtr doc, MSXML_VERSION version)
 {
     doc->_private = create_priv();
@@ -715,43 +723,75 @@ static HRESULT WINAPI PersistStreamInit_IsDirty(
     return S_FALSE;
 }
 
+/* Streams are fed to the parser in chunks of this size, so loading a document
+ * does not need a copy of all of its source data. */
+#define LOAD_CHUNK_SIZE 0x10000
+
 static HRESULT domdoc_load_from_stream(domdoc *doc, ISequentialStream *stream)
 {
-    DWORD read, written, len;
-    xmlDocPtr xmldoc = NULL;
-    IStream *hstream;
-    HGLOBAL hglobal;
-    BYTE buf[4096];
+    xmlParserCtxtPtr pctx;
+    xmlDocPtr xmldoc;
+    DWORD read, len = 0;
     HRESULT hr;
-    char *ptr;
+    char *buf;
 
-    hstream = NULL;
-    hr = CreateStreamOnHGlobal(NULL, TRUE, &hstream);
-    if (FAILED(hr))
-        return hr;
+    buf = heap_alloc(LOAD_CHUNK_SIZE);
+    if (!buf)
+        return E_OUTOFMEMORY;
 
+    /* the parser needs the first four bytes to detect the encoding */
     do
     {
-        ISequentialStream_Read(stream, buf, sizeof(buf), &read);
-        hr = IStream_Write(hstream, buf, read, &written);
-    } while(SUCCEEDED(hr) && written != 0 && read != 0);
+        read = 0;
+        hr = ISequentialStream_Read(stream, buf + len, LOAD_CHUNK_SIZE - len, &read);
+        if (FAILED(hr))
+        {
+            ERR("failed to read stream 0x%08x\n", hr);
+            heap_free(buf);
+            return hr;
+        }
+        len += read;
+    } while (read && len < 4);
 
-    if (FAILED(hr))
+    pctx = xmlCreatePushParserCtxt(&sax_handler, NULL, buf, len, NULL);
+    if (!pctx)
     {
-        ERR("failed to copy stream 0x%08x\n", hr);
-        IStream_Release(hstream);
-        return hr;
+        ERR("Failed to create parser context\n");
+        heap_free(buf);
+        return E_FAIL;
+    }
+
+    xmlFree(pctx->sax);
+    pctx->sax = &sax_handler;
+    pctx->_private = doc;
+    pctx->recovery = 0;
+
+    while (read && pctx->wellFormed)
+    {
+        read = 0;
+        hr = ISequentialStream_Read(stream, buf, LOAD_CHUNK_SIZE, &read);
+        if (FAILED(hr))
+        {
+            ERR("failed to read stream 0x%08x\n", hr);
+            break;
+        }
+
+        if (read)
+            xmlParseChunk(pctx, buf, read, 0);
     }
 
-    hr = GetHGlobalFromStream(hstream, &hglobal);
+    heap_free(buf);
+
     if (FAILED(hr))
+    {
+        pctx->sax = NULL;
+        xmlFreeDoc(pctx->myDoc);
+        xmlFreeParserCtxt(pctx);
         return hr;
+    }
 
-    len = GlobalSize(hglobal);
-    ptr = GlobalLock(hglobal);
-    if (len)
-        xmldoc = doparse(doc, ptr, len, XML_CHAR_ENCODING_NONE);
-    GlobalUnlock(hglobal);
+    xmlParseChunk(pctx, NULL, 0, 1);
+    xmldoc = doparse_finish(pctx);
 
     if (!xmldoc)
     {
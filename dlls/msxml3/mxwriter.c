@@ -385,73 +385,61 @@ static void close_output_buffer(mxwriter *This)
     get_code_page(This->xml_enc, &This->buffer->code_page);
 }
 
-/* escapes special characters like:
+/* writes data with special characters escaped, like:
    '<' -> "&lt;"
    '&' -> "&amp;"
    '"' -> "&quot;"
    '>' -> "&gt;"
+   Runs of characters that need no escaping are written as they are.
 */
-static WCHAR *get_escaped_string(const WCHAR *str, escape_mode mode, int *len)
+static HRESULT write_output_buffer_escaped(output_buffer *buffer, escape_mode mode, const WCHAR *str, int len)
 {
     static const WCHAR ltW[]    = {'&','l','t',';'};
     static const WCHAR ampW[]   = {'&','a','m','p',';'};
     static const WCHAR equotW[] = {'&','q','u','o','t',';'};
     static const WCHAR gtW[]    = {'&','g','t',';'};
 
-    const int default_alloc = 100;
-    const int grow_thresh = 10;
-    int p = *len, conv_len;
-    WCHAR *ptr, *ret;
+    /* all special characters are below 64, so they fit in a bitmask */
+    ULONGLONG special = ((ULONGLONG)1 << '<') | ((ULONGLONG)1 << '&') | ((ULONGLONG)1 << '>');
+    const WCHAR *run = str;
 
-    /* default buffer size to something if length is unknown */
-    conv_len = *len == -1 ? default_alloc : max(2**len, default_alloc);
-    ptr = ret = heap_alloc(conv_len*sizeof(WCHAR));
+    if (mode == EscapeValue)
+        special |= (ULONGLONG)1 << '"';
 
-    while (*str && p)
+    while (*str && len)
     {
-        if (ptr - ret > conv_len - grow_thresh)
+        if (*str < 64 && (special >> *str) & 1)
         {
-            int written = ptr - ret;
-            conv_len *= 2;
-            ptr = ret = heap_realloc(ret, conv_len*sizeof(WCHAR));
-            ptr += written;
-        }
+            if (str > run)
+                write_output_buffer(buffer, run, str - run);
 
-        switch (*str)
-        {
-        case '<':
-            memcpy(ptr, ltW, sizeof(ltW));
-            ptr += sizeof(ltW)/sizeof(WCHAR);
-            break;
-        case '&':
-            memcpy(ptr, ampW, sizeof(ampW));
-            ptr += sizeof(ampW)/sizeof(WCHAR);
-            break;
-        case '>':
-            memcpy(ptr, gtW, sizeof(gtW));
-            ptr += sizeof(gtW)/sizeof(WCHAR);
-            break;
-        case '"':
-            if (mode == EscapeValue)
+            switch (*str)
             {
-                memcpy(ptr, equotW, sizeof(equotW));
-                ptr += sizeof(equotW)/sizeof(WCHAR);
+            case '<':
+                write_output_buffer(buffer, ltW, sizeof(ltW)/sizeof(WCHAR));
+                break;
+            case '&':
+                write_output_buffer(buffer, ampW, sizeof(ampW)/sizeof(WCHAR));
+                break;
+            case '>':
+                write_output_buffer(buffer, gtW, sizeof(gtW)/sizeof(WCHAR));
+                break;
+            case '"':
+                write_output_buffer(buffer, equotW, sizeof(equotW)/sizeof(WCHAR));
                 break;
             }
-            /* fallthrough for text mode */
-        default:
-            *ptr++ = *str;
-            break;
+
+            run = str + 1;
         }
 
         str++;
-        if (*len != -1) p--;
+        if (len != -1) len--;
     }
 
-    if (*len != -1) *len = ptr-ret;
-    *++ptr = 0;
+    if (str > run)
+        write_output_buffer(buffer, run, str - run);
 
-    return ret;
+    return S_OK;
 }
 
 static void write_prolog_buffer(const mxwriter *This)
@@ -527,6 +515,43 @@ static HRESULT write_data_to_stream(mxwriter *This)
     return hr;
 }
 
+/* Output for a stream is written out once this much of it is buffered,
+ * instead of keeping the whole document in memory until it ends. */
+#define STREAM_FLUSH_THRESHOLD 0x10000
+
+static HRESULT write_data_to_stream_if_full(mxwriter *This)
+{
+    encoded_buffer *buffer;
+    HRESULT hr;
+
+    if (!This->dest)
+        return S_OK;
+
+    if (This->xml_enc != XmlEncoding_UTF16)
+        buffer = &This->buffer->encoded;
+    else
+        buffer = &This->buffer->utf16;
+
+    if (buffer->written < STREAM_FLUSH_THRESHOLD)
+        return S_OK;
+
+    hr = write_data_to_stream(This);
+    if (FAILED(hr))
+        return hr;
+
+    /* Start over once everything buffered is in the stream. The UTF-16
+     * copy is never returned when writing to a stream, so drop it too. */
+    if (This->dest_written == buffer->written)
+    {
+        This->buffer->utf16.written = 0;
+        memset(This->buffer->utf16.data, 0, sizeof(WCHAR));
+        This->buffer->encoded.written = 0;
+        This->dest_written = 0;
+    }
+
+    return S_OK;
+}
+
 /* Newly added element start tag left unclosed cause for empty elements
    we have to close it differently. */
 static void close_element_starttag(const mxwriter *This)
@@ -1117,9 +1142,9 @@ static HRESULT WINAPI SAXContentHandler_startElement(
 
             if (escape)
             {
-                WCHAR *escaped = get_escaped_string(str, EscapeValue, &len);
-                write_output_buffer_quoted(This->buffer, escaped, len);
-                heap_free(escaped);
+                write_output_buffer(This->buffer, quotW, 1);
+                write_output_buffer_escaped(This->buffer, EscapeValue, str, len);
+                write_output_buffer(This->buffer, quotW, 1);
             }
             else
                 write_output_buffer_quoted(This->buffer, str, len);
@@ -1164,7 +1189,7 @@ static HRESULT WINAPI SAXContentHandler_endElement(
 
     set_element_name(This, NULL, 0);
 
-    return S_OK;
+    return write_data_to_stream_if_full(This);
 }
 
 static HRESULT WINAPI SAXContentHandler_characters(
@@ -1186,17 +1211,10 @@ static HRESULT WINAPI SAXContentHandler_characters(
         if (This->cdata || This->props[MXWriter_DisableEscaping] == VARIANT_TRUE)
             write_output_buffer(This->buffer, chars, nchars);
         else
-        {
-            int len = nchars;
-            WCHAR *escaped;
-
-            escaped = get_escaped_string(chars, EscapeText, &len);
-            write_output_buffer(This->buffer, escaped, len);
-            heap_free(escaped);
-        }
+            write_output_buffer_escaped(This->buffer, EscapeText, chars, nchars);
     }
 
-    return S_OK;
+    return write_data_to_stream_if_full(This);
 }
 
 static HRESULT WINAPI SAXContentHandler_ignorableWhitespace(
@@ -1212,7 +1230,7 @@ static HRESULT WINAPI SAXContentHandler_ignorableWhitespace(
 
     write_output_buffer(This->buffer, chars, nchars);
 
-    return S_OK;
+    return write_data_to_stream_if_full(This);
 }
 
 static HRESULT WINAPI SAXContentHandler_processingInstruction(
@@ -1243,7 +1261,7 @@ static HRESULT WINAPI SAXContentHandler_processingInstruction(
 
     write_output_buffer(This->buffer, closepiW, sizeof(closepiW)/sizeof(WCHAR));
 
-    return S_OK;
+    return write_data_to_stream_if_full(This);
 }
 
 static HRESULT WINAPI SAXContentHandler_skippedEntity(
@@ -1417,7 +1435,7 @@ static HRESULT WINAPI SAXLexicalHandler_comment(ISAXLexicalHandler *iface, const
         write_output_buffer(This->buffer, chars, nchars);
     write_output_buffer(This->buffer, ccloseW, sizeof(ccloseW)/sizeof(WCHAR));
 
-    return S_OK;
+    return write_data_to_stream_if_full(This);
 }
 
 static const struct ISAXLexicalHandlerVtbl SAXLexicalHandlerVtbl =
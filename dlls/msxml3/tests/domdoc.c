@@ -9255,6 +9255,10 @@ static void test_load(void)
     BSTR path, bstr1, bstr2;
     DWORD written;
     void* ptr;
+    IStream *stream;
+    LARGE_INTEGER pos;
+    LONG len;
+    int i;
 
     /* prepare a file */
     hfile = CreateFileA("test.xml", GENERIC_WRITE|GENERIC_READ, 0, NULL, CREATE_ALWAYS, FILE_ATTRIBUTE_NORMAL, NULL );
@@ -9391,6 +9395,42 @@ static void test_load(void)
     VariantClear(&src);
     IXMLDOMDocument_Release(doc);
 
+    /* stream larger than a single read */
+    hr = CreateStreamOnHGlobal(NULL, TRUE, &stream);
+    EXPECT_HR(hr, S_OK);
+
+    hr = IStream_Write(stream, "<?xml version=\"1.0\"?><root>", 27, NULL);
+    EXPECT_HR(hr, S_OK);
+    for (i = 0; i < 20000; i++)
+    {
+        hr = IStream_Write(stream, "<a>text</a>", 11, NULL);
+        EXPECT_HR(hr, S_OK);
+    }
+    hr = IStream_Write(stream, "</root>", 7, NULL);
+    EXPECT_HR(hr, S_OK);
+
+    pos.QuadPart = 0;
+    hr = IStream_Seek(stream, pos, STREAM_SEEK_SET, NULL);
+    EXPECT_HR(hr, S_OK);
+
+    doc = create_document(&IID_IXMLDOMDocument);
+
+    V_VT(&src) = VT_UNKNOWN;
+    V_UNKNOWN(&src) = (IUnknown*)stream;
+    hr = IXMLDOMDocument_load(doc, src, &b);
+    EXPECT_HR(hr, S_OK);
+    ok(b == VARIANT_TRUE, "got %d\n", b);
+
+    hr = IXMLDOMDocument_selectNodes(doc, _bstr_("/root/a"), &list);
+    EXPECT_HR(hr, S_OK);
+    hr = IXMLDOMNodeList_get_length(list, &len);
+    EXPECT_HR(hr, S_OK);
+    ok(len == 20000, "got %d\n", len);
+    IXMLDOMNodeList_Release(list);
+
+    IXMLDOMDocument_Release(doc);
+    IStream_Release(stream);
+
     free_bstrs();
 }
 
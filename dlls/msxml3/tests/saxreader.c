@@ -3807,6 +3807,9 @@ static const mxwriter_stream_test mxwriter_stream_tests[] = {
 
 static void test_mxwriter_stream(void)
 {
+    static const WCHAR emptyW[] = {0};
+    static const WCHAR aW[] = {'a',0};
+    static const WCHAR charsW[] = {'x','&',0};
     IMXWriter *writer;
     ISAXContentHandler *content;
     HRESULT hr;
@@ -3815,6 +3818,8 @@ static void test_mxwriter_stream(void)
     LARGE_INTEGER pos;
     ULARGE_INTEGER pos2;
     DWORD test_count = sizeof(mxwriter_stream_tests)/sizeof(mxwriter_stream_tests[0]);
+    char buff[32];
+    int i;
 
     for(current_stream_test_index = 0; current_stream_test_index < test_count; ++current_stream_test_index) {
         const mxwriter_stream_test *test = mxwriter_stream_tests+current_stream_test_index;
@@ -3931,6 +3936,64 @@ static void test_mxwriter_stream(void)
 
     ISAXContentHandler_Release(content);
     IMXWriter_Release(writer);
+    IStream_Release(stream);
+
+    /* large output is passed to the stream while it's being written */
+    hr = CoCreateInstance(&CLSID_MXXMLWriter, NULL, CLSCTX_INPROC_SERVER,
+            &IID_IMXWriter, (void**)&writer);
+    ok(hr == S_OK, "CoCreateInstance failed: %08x\n", hr);
+
+    hr = CreateStreamOnHGlobal(NULL, TRUE, &stream);
+    ok(hr == S_OK, "CreateStreamOnHGlobal failed: %08x\n", hr);
+
+    hr = IMXWriter_QueryInterface(writer, &IID_ISAXContentHandler, (void**)&content);
+    ok(hr == S_OK, "QueryInterface(ISAXContentHandler) failed: %08x\n", hr);
+
+    hr = IMXWriter_put_encoding(writer, _bstr_("UTF-8"));
+    EXPECT_HR(hr, S_OK);
+
+    hr = IMXWriter_put_omitXMLDeclaration(writer, VARIANT_TRUE);
+    EXPECT_HR(hr, S_OK);
+
+    V_VT(&dest) = VT_UNKNOWN;
+    V_UNKNOWN(&dest) = (IUnknown*)stream;
+    hr = IMXWriter_put_output(writer, dest);
+    EXPECT_HR(hr, S_OK);
+
+    hr = ISAXContentHandler_startDocument(content);
+    EXPECT_HR(hr, S_OK);
+
+    for (i = 0; i < 10000; i++)
+    {
+        hr = ISAXContentHandler_startElement(content, emptyW, 0, emptyW, 0, aW, 1, NULL);
+        EXPECT_HR(hr, S_OK);
+
+        hr = ISAXContentHandler_characters(content, charsW, 2);
+        EXPECT_HR(hr, S_OK);
+
+        hr = ISAXContentHandler_endElement(content, emptyW, 0, emptyW, 0, aW, 1);
+        EXPECT_HR(hr, S_OK);
+    }
+
+    hr = ISAXContentHandler_endDocument(content);
+    EXPECT_HR(hr, S_OK);
+
+    pos.QuadPart = 0;
+    hr = IStream_Seek(stream, pos, STREAM_SEEK_CUR, &pos2);
+    EXPECT_HR(hr, S_OK);
+    ok(pos2.QuadPart == 10000 * 13, "got wrong position %s\n", wine_dbgstr_longlong(pos2.QuadPart));
+
+    hr = IStream_Seek(stream, pos, STREAM_SEEK_SET, NULL);
+    EXPECT_HR(hr, S_OK);
+
+    memset(buff, 0, sizeof(buff));
+    hr = IStream_Read(stream, buff, 26, NULL);
+    EXPECT_HR(hr, S_OK);
+    ok(!strcmp(buff, "<a>x&amp;</a><a>x&amp;</a>"), "got %s\n", buff);
+
+    ISAXContentHandler_Release(content);
+    IMXWriter_Release(writer);
+    IStream_Release(stream);
 
     free_bstrs();
 }
@@ -26,6 +26,7 @@
 
 #include <stdarg.h>
 #include <stdio.h>
+#include <stdlib.h>
 
 #define NONAMELESSUNION
 #define NONAMELESSSTRUCT
@@ -163,6 +164,23 @@ struct assembly
     struct entity_array      entities;
 };
 
+/* entry of a string section index, sorted by hash */
+struct string_index_entry
+{
+    ULONG               hash;
+    unsigned int        order;          /* position in manifest order, to keep the first match */
+    const WCHAR        *name;
+    void               *data;
+    void               *section_base;
+    unsigned int        assembly;
+};
+
+struct string_index
+{
+    unsigned int              count;
+    struct string_index_entry entries[1];
+};
+
 typedef struct _ACTIVATION_CONTEXT
 {
     ULONG               magic;
@@ -172,6 +190,8 @@ typedef struct _ACTIVATION_CONTEXT
     struct assembly    *assemblies;
     unsigned int        num_assemblies;
     unsigned int        allocated_assemblies;
+    struct string_index *dll_index;      /* dll redirection section, built on first lookup */
+    struct string_index *wndclass_index; /* window class section, built on first lookup */
 } ACTIVATION_CONTEXT;
 
 struct actctx_loader
@@ -640,6 +660,8 @@ static void actctx_release( ACTIVATION_CONTEXT *actctx )
         RtlFreeHeap( GetProcessHeap(), 0, actctx->config.info );
         RtlFreeHeap( GetProcessHeap(), 0, actctx->appdir.info );
         RtlFreeHeap( GetProcessHeap(), 0, actctx->assemblies );
+        RtlFreeHeap( GetProcessHeap(), 0, actctx->dll_index );
+        RtlFreeHeap( GetProcessHeap(), 0, actctx->wndclass_index );
         actctx->magic = 0;
         RtlFreeHeap( GetProcessHeap(), 0, actctx );
     }
@@ -2128,28 +2150,90 @@ static NTSTATUS fill_keyed_data(PACTCTX_SECTION_KEYED_DATA data, PVOID v1, PVOID
     return STATUS_SUCCESS;
 }
 
-static NTSTATUS find_dll_redirection(ACTIVATION_CONTEXT* actctx, const UNICODE_STRING *section_name,
-                                     PACTCTX_SECTION_KEYED_DATA data)
+/* case-insensitive x65599 hash, folding case the same way as strncmpiW */
+static ULONG hash_section_name( const WCHAR *name, unsigned int len )
+{
+    ULONG hash = 0;
+
+    while (len--) hash = hash * 65599 + tolowerW( *name++ );
+    return hash;
+}
+
+static int compare_index_entries( const void *p1, const void *p2 )
+{
+    const struct string_index_entry *e1 = p1, *e2 = p2;
+
+    if (e1->hash != e2->hash) return e1->hash < e2->hash ? -1 : 1;
+    return e1->order < e2->order ? -1 : (e1->order > e2->order);
+}
+
+static struct string_index *alloc_string_index( unsigned int count )
 {
-    unsigned int i, j, snlen = section_name->Length / sizeof(WCHAR);
+    struct string_index *index;
+
+    index = RtlAllocateHeap( GetProcessHeap(), 0,
+                             FIELD_OFFSET( struct string_index, entries[count ? count : 1] ));
+    if (index) index->count = 0;
+    return index;
+}
+
+static void add_index_entry( struct string_index *index, const WCHAR *name, void *data,
+                             void *section_base, unsigned int assembly )
+{
+    struct string_index_entry *entry = &index->entries[index->count];
+
+    entry->hash         = hash_section_name( name, strlenW(name) );
+    entry->order        = index->count++;
+    entry->name         = name;
+    entry->data         = data;
+    entry->section_base = section_base;
+    entry->assembly     = assembly;
+}
+
+/* publish a newly built index, unless another thread got there first */
+static struct string_index *set_string_index( struct string_index **ptr, struct string_index *index )
+{
+    qsort( index->entries, index->count, sizeof(index->entries[0]), compare_index_entries );
+    if (interlocked_cmpxchg_ptr( (void **)ptr, index, NULL ))
+        RtlFreeHeap( GetProcessHeap(), 0, index );
+    return *ptr;
+}
+
+static struct string_index *get_dll_index( ACTIVATION_CONTEXT *actctx )
+{
+    struct string_index *index;
+    unsigned int i, j, count = 0;
+
+    if (actctx->dll_index) return actctx->dll_index;
+
+    for (i = 0; i < actctx->num_assemblies; i++) count += actctx->assemblies[i].num_dlls;
+    if (!(index = alloc_string_index( count ))) return NULL;
 
     for (i = 0; i < actctx->num_assemblies; i++)
     {
         struct assembly *assembly = &actctx->assemblies[i];
         for (j = 0; j < assembly->num_dlls; j++)
-        {
-            struct dll_redirect *dll = &assembly->dlls[j];
-            if (!strncmpiW(section_name->Buffer, dll->name, snlen) && !dll->name[snlen])
-                return fill_keyed_data(data, dll, assembly, i);
-        }
+            add_index_entry( index, assembly->dlls[j].name, &assembly->dlls[j], assembly, i );
     }
-    return STATUS_SXS_KEY_NOT_FOUND;
+    return set_string_index( &actctx->dll_index, index );
 }
 
-static NTSTATUS find_window_class(ACTIVATION_CONTEXT* actctx, const UNICODE_STRING *section_name,
-                                  PACTCTX_SECTION_KEYED_DATA data)
+static struct string_index *get_wndclass_index( ACTIVATION_CONTEXT *actctx )
 {
-    unsigned int i, j, k, snlen = section_name->Length / sizeof(WCHAR);
+    struct string_index *index;
+    unsigned int i, j, k, count = 0;
+
+    if (actctx->wndclass_index) return actctx->wndclass_index;
+
+    for (i = 0; i < actctx->num_assemblies; i++)
+    {
+        struct assembly *assembly = &actctx->assemblies[i];
+        for (j = 0; j < assembly->num_dlls; j++)
+            for (k = 0; k < assembly->dlls[j].entities.num; k++)
+                if (assembly->dlls[j].entities.base[k].kind == ACTIVATION_CONTEXT_SECTION_WINDOW_CLASS_REDIRECTION)
+                    count++;
+    }
+    if (!(index = alloc_string_index( count ))) return NULL;
 
     for (i = 0; i < actctx->num_assemblies; i++)
     {
@@ -2161,16 +2245,54 @@ static NTSTATUS find_window_class(ACTIVATION_CONTEXT* actctx, const UNICODE_STRI
             {
                 struct entity *entity = &dll->entities.base[k];
                 if (entity->kind == ACTIVATION_CONTEXT_SECTION_WINDOW_CLASS_REDIRECTION)
-                {
-                    if (!strncmpiW(section_name->Buffer, entity->u.class.name, snlen) && !entity->u.class.name[snlen])
-                        return fill_keyed_data(data, entity, dll, i);
-                }
+                    add_index_entry( index, entity->u.class.name, entity, dll, i );
             }
         }
     }
+    return set_string_index( &actctx->wndclass_index, index );
+}
+
+static NTSTATUS find_index_entry( const struct string_index *index, const UNICODE_STRING *section_name,
+                                  PACTCTX_SECTION_KEYED_DATA data )
+{
+    unsigned int snlen = section_name->Length / sizeof(WCHAR);
+    ULONG hash = hash_section_name( section_name->Buffer, snlen );
+    int min = 0, max = index->count - 1;
+
+    /* find the first entry with a matching hash */
+    while (min < max)
+    {
+        int pos = (min + max) / 2;
+        if (index->entries[pos].hash < hash) min = pos + 1;
+        else max = pos;
+    }
+    for ( ; min < index->count && index->entries[min].hash == hash; min++)
+    {
+        const struct string_index_entry *entry = &index->entries[min];
+        if (!strncmpiW( section_name->Buffer, entry->name, snlen ) && !entry->name[snlen])
+            return fill_keyed_data( data, entry->data, entry->section_base, entry->assembly );
+    }
     return STATUS_SXS_KEY_NOT_FOUND;
 }
 
+static NTSTATUS find_dll_redirection(ACTIVATION_CONTEXT* actctx, const UNICODE_STRING *section_name,
+                                     PACTCTX_SECTION_KEYED_DATA data)
+{
+    struct string_index *index = get_dll_index( actctx );
+
+    if (!index) return STATUS_NO_MEMORY;
+    return find_index_entry( index, section_name, data );
+}
+
+static NTSTATUS find_window_class(ACTIVATION_CONTEXT* actctx, const UNICODE_STRING *section_name,
+                                  PACTCTX_SECTION_KEYED_DATA data)
+{
+    struct string_index *index = get_wndclass_index( actctx );
+
+    if (!index) return STATUS_NO_MEMORY;
+    return find_index_entry( index, section_name, data );
+}
+
 static NTSTATUS find_string(ACTIVATION_CONTEXT* actctx, ULONG section_kind,
                             const UNICODE_STRING *section_name,
                             DWORD flags, PACTCTX_SECTION_KEYED_DATA data)
@@ -39,6 +39,7 @@
 
 #include "wine/exception.h"
 #include "wine/library.h"
+#include "wine/list.h"
 #include "wine/unicode.h"
 #include "wine/debug.h"
 #include "wine/server.h"
@@ -76,10 +77,15 @@ static const WCHAR dllW[] = {'.','d','l','l',0};
 typedef struct _wine_modref
 {
     LDR_MODULE            ldr;
+    struct list           hash_entry;   /* entry in the module name hash table */
     int                   nDeps;
     struct _wine_modref **deps;
 } WINE_MODREF;
 
+/* hash table of the loaded modules, indexed by case-insensitive base name */
+#define MODULE_HASH_SIZE 64
+static struct list module_hash_table[MODULE_HASH_SIZE];
+
 /* info about the current builtin dll load */
 /* used to keep track of things across the register_dll constructor call */
 struct builtin_load_info
@@ -113,6 +119,9 @@ static WINE_MODREF *cached_modref;
 static WINE_MODREF *current_modref;
 static WINE_MODREF *last_failed_modref;
 
+static LARGE_INTEGER process_init_time;  /* time at which the process started loading dlls */
+static unsigned int import_hint_misses;  /* named imports whose hint didn't match */
+
 static NTSTATUS load_dll( LPCWSTR load_path, LPCWSTR libname, DWORD flags, WINE_MODREF** pwm );
 static NTSTATUS process_attach( WINE_MODREF *wm, LPVOID lpReserved );
 static FARPROC find_ordinal_export( HMODULE module, const IMAGE_EXPORT_DIRECTORY *exports,
@@ -344,6 +353,39 @@ static WINE_MODREF *get_modref( HMODULE hmod )
 }
 
 
+/**********************************************************************
+ *	    hash_module_name
+ *
+ * Compute the case-insensitive hash of the base name part of a module name.
+ */
+static unsigned int hash_module_name( LPCWSTR name )
+{
+    const WCHAR *p;
+    unsigned int hash = 0;
+
+    if ((p = strrchrW( name, '\\' ))) name = p + 1;
+    for (p = name; *p; p++) hash = hash * 31 + tolowerW( *p );
+    return hash % MODULE_HASH_SIZE;
+}
+
+
+/**********************************************************************
+ *	    get_module_hash_bucket
+ *
+ * Return the hash table bucket for a module name, initializing the table if needed.
+ * The loader_section must be locked while calling this function
+ */
+static struct list *get_module_hash_bucket( LPCWSTR name )
+{
+    if (!module_hash_table[0].next)
+    {
+        unsigned int i;
+        for (i = 0; i < MODULE_HASH_SIZE; i++) list_init( &module_hash_table[i] );
+    }
+    return &module_hash_table[hash_module_name( name )];
+}
+
+
 /**********************************************************************
  *	    find_basename_module
  *
@@ -352,18 +394,16 @@ static WINE_MODREF *get_modref( HMODULE hmod )
  */
 static WINE_MODREF *find_basename_module( LPCWSTR name )
 {
-    PLIST_ENTRY mark, entry;
+    WINE_MODREF *wm;
 
     if (cached_modref && !strcmpiW( name, cached_modref->ldr.BaseDllName.Buffer ))
         return cached_modref;
 
-    mark = &NtCurrentTeb()->Peb->LdrData->InLoadOrderModuleList;
-    for (entry = mark->Flink; entry != mark; entry = entry->Flink)
+    LIST_FOR_EACH_ENTRY( wm, get_module_hash_bucket( name ), WINE_MODREF, hash_entry )
     {
-        LDR_MODULE *mod = CONTAINING_RECORD(entry, LDR_MODULE, InLoadOrderModuleList);
-        if (!strcmpiW( name, mod->BaseDllName.Buffer ))
+        if (!strcmpiW( name, wm->ldr.BaseDllName.Buffer ))
         {
-            cached_modref = CONTAINING_RECORD(mod, WINE_MODREF, ldr);
+            cached_modref = wm;
             return cached_modref;
         }
     }
@@ -379,18 +419,16 @@ static WINE_MODREF *find_basename_module( LPCWSTR name )
  */
 static WINE_MODREF *find_fullname_module( LPCWSTR name )
 {
-    PLIST_ENTRY mark, entry;
+    WINE_MODREF *wm;
 
     if (cached_modref && !strcmpiW( name, cached_modref->ldr.FullDllName.Buffer ))
         return cached_modref;
 
-    mark = &NtCurrentTeb()->Peb->LdrData->InLoadOrderModuleList;
-    for (entry = mark->Flink; entry != mark; entry = entry->Flink)
+    LIST_FOR_EACH_ENTRY( wm, get_module_hash_bucket( name ), WINE_MODREF, hash_entry )
     {
-        LDR_MODULE *mod = CONTAINING_RECORD(entry, LDR_MODULE, InLoadOrderModuleList);
-        if (!strcmpiW( name, mod->FullDllName.Buffer ))
+        if (!strcmpiW( name, wm->ldr.FullDllName.Buffer ))
         {
-            cached_modref = CONTAINING_RECORD(mod, WINE_MODREF, ldr);
+            cached_modref = wm;
             return cached_modref;
         }
     }
@@ -524,6 +562,7 @@ static FARPROC find_named_export( HMODULE module, const IMAGE_EXPORT_DIRECTORY *
         char *ename = get_rva( module, names[hint] );
         if (!strcmp( ename, name ))
             return find_ordinal_export( module, exports, exp_size, ordinals[hint], load_path );
+        import_hint_misses++;
     }
 
     /* then do a binary search */
@@ -838,6 +877,7 @@ static WINE_MODREF *alloc_module( HMODULE hModule, LPCWSTR filename )
 
     InsertTailList(&NtCurrentTeb()->Peb->LdrData->InLoadOrderModuleList,
                    &wm->ldr.InLoadOrderModuleList);
+    list_add_tail( get_module_hash_bucket( wm->ldr.BaseDllName.Buffer ), &wm->hash_entry );
 
     /* insert module in MemoryList, sorted in increasing base addresses */
     mark = &NtCurrentTeb()->Peb->LdrData->InMemoryOrderModuleList;
@@ -1480,6 +1520,7 @@ static void load_builtin_callback( void *module, const char *filename )
             /* the module has only be inserted in the load & memory order lists */
             RemoveEntryList(&wm->ldr.InLoadOrderModuleList);
             RemoveEntryList(&wm->ldr.InMemoryOrderModuleList);
+            list_remove( &wm->hash_entry );
             /* FIXME: free the modref */
             builtin_load_info->status = STATUS_DLL_NOT_FOUND;
             return;
@@ -1552,6 +1593,7 @@ static NTSTATUS load_native_dll( LPCWSTR load_path, LPCWSTR name, HANDLE file,
             /* the module has only be inserted in the load & memory order lists */
             RemoveEntryList(&wm->ldr.InLoadOrderModuleList);
             RemoveEntryList(&wm->ldr.InMemoryOrderModuleList);
+            list_remove( &wm->hash_entry );
 
             /* FIXME: there are several more dangling references
              * left. Including dlls loaded by this dll before the
@@ -2403,6 +2445,7 @@ static void free_modref( WINE_MODREF *wm )
 {
     RemoveEntryList(&wm->ldr.InLoadOrderModuleList);
     RemoveEntryList(&wm->ldr.InMemoryOrderModuleList);
+    list_remove( &wm->hash_entry );
     if (wm->ldr.InInitializationOrderModuleList.Flink)
         RemoveEntryList(&wm->ldr.InInitializationOrderModuleList);
 
@@ -2588,6 +2631,16 @@ static NTSTATUS attach_process_dlls( void *wm )
     }
     attach_implicitly_loaded_dlls( (LPVOID)1 );
     RtlLeaveCriticalSection( &loader_section );
+
+    if (TRACE_ON(loaddll))
+    {
+        LARGE_INTEGER now;
+
+        NtQuerySystemTime( &now );
+        TRACE_(loaddll)( "Process startup took %u ms, %u named imports missed their hint\n",
+                         (unsigned int)((now.QuadPart - process_init_time.QuadPart) / 10000),
+                         import_hint_misses );
+    }
     return status;
 }
 
@@ -2861,6 +2914,7 @@ void CDECL __wine_init_windows_dir( const WCHAR *windir, const WCHAR *sysdir )
     for (entry = mark->Flink; entry != mark; entry = entry->Flink)
     {
         LDR_MODULE *mod = CONTAINING_RECORD( entry, LDR_MODULE, InLoadOrderModuleList );
+        WINE_MODREF *wm = CONTAINING_RECORD( mod, WINE_MODREF, ldr );
 
         assert( mod->Flags & LDR_WINE_INTERNAL );
 
@@ -2873,6 +2927,10 @@ void CDECL __wine_init_windows_dir( const WCHAR *windir, const WCHAR *sysdir )
         strcpyW( p, mod->FullDllName.Buffer );
         RtlInitUnicodeString( &mod->FullDllName, buffer );
         RtlInitUnicodeString( &mod->BaseDllName, p );
+
+        /* the base name may have changed, move the module to its new hash bucket */
+        list_remove( &wm->hash_entry );
+        list_add_tail( get_module_hash_bucket( mod->BaseDllName.Buffer ), &wm->hash_entry );
     }
 }
 
@@ -2890,6 +2948,7 @@ void __wine_process_init(void)
     void (* DECLSPEC_NORETURN CDECL init_func)(void);
 
     main_exe_file = thread_init();
+    if (TRACE_ON(loaddll)) NtQuerySystemTime( &process_init_time );
 
     /* retrieve current umask */
     FILE_umask = umask(0777);
@@ -543,10 +543,12 @@ static void test_TypeInfo(void)
     static WCHAR wszBogus[] = { 'b','o','g','u','s',0 };
     static WCHAR wszGetTypeInfo[] = { 'G','e','t','T','y','p','e','I','n','f','o',0 };
     static WCHAR wszClone[] = {'C','l','o','n','e',0};
+    static WCHAR wszclone[] = {'c','l','o','n','e',0};
     OLECHAR* bogus = wszBogus;
     OLECHAR* pwszGetTypeInfo = wszGetTypeInfo;
     OLECHAR* pwszClone = wszClone;
-    DISPID dispidMember;
+    OLECHAR* pwszclone = wszclone;
+    DISPID dispidMember, dispidMember2;
     DISPPARAMS dispparams;
     GUID bogusguid = {0x806afb4f,0x13f7,0x42d2,{0x89,0x2c,0x6c,0x97,0xc3,0x6a,0x36,0xc1}};
     VARIANT var;
@@ -613,6 +615,11 @@ static void test_TypeInfo(void)
     hr = ITypeInfo_GetIDsOfNames(pTypeInfo, &pwszClone, 1, &dispidMember);
     ok_ole_success(hr, ITypeInfo_GetIDsOfNames);
 
+    /* names are case insensitive */
+    hr = ITypeInfo_GetIDsOfNames(pTypeInfo, &pwszclone, 1, &dispidMember2);
+    ok_ole_success(hr, ITypeInfo_GetIDsOfNames);
+    ok(dispidMember2 == dispidMember, "got %d, expected %d\n", dispidMember2, dispidMember);
+
     /* correct member id -- wrong flags -- cNamedArgs not bigger than cArgs */
     dispparams.cNamedArgs = 0;
     hr = ITypeInfo_Invoke(pTypeInfo, (void *)0xdeadbeef, dispidMember, DISPATCH_PROPERTYGET, &dispparams, NULL, NULL, NULL);
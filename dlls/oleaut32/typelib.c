@@ -1070,6 +1070,7 @@ typedef struct tagTLBFuncDesc
     BSTR HelpString;
     BSTR Entry;            /* if IS_INTRESOURCE true, it's numeric; if -1 it isn't present */
     struct list custdata_list;
+    VARTYPE *param_vts;    /* variant types of the parameters, computed on first Invoke */
 } TLBFuncDesc;
 
 /* internal Variable data */
@@ -1092,6 +1093,22 @@ typedef struct tagTLBImplType
 } TLBImplType;
 
 /* internal TypeInfo data */
+/* member name index used by GetIDsOfNames */
+struct tlb_name_entry
+{
+    struct tlb_name_entry *next;
+    const OLECHAR *name;
+    const TLBFuncDesc *func;    /* function with this name, or NULL */
+    const TLBVarDesc *var;      /* variable with this name, or NULL */
+};
+
+struct tlb_name_hash
+{
+    UINT size;                  /* 0 if some member names can't be hashed */
+    struct tlb_name_entry **buckets;
+    struct tlb_name_entry entries[1];
+};
+
 typedef struct tagITypeInfoImpl
 {
     const ITypeInfo2Vtbl *lpVtbl;
@@ -1121,6 +1138,10 @@ typedef struct tagITypeInfoImpl
     TLBImplType *impltypes;
 
     struct list custdata_list;
+
+    /* case-insensitive index of the member names, built on first use */
+    struct tlb_name_hash *name_hash;
+    BOOL name_hash_shared;      /* name_hash belongs to the typeinfo this one was copied from */
 } ITypeInfoImpl;
 
 static inline ITypeInfoImpl *info_impl_from_ITypeComp( ITypeComp *iface )
@@ -2445,7 +2466,9 @@ static ITypeInfoImpl * MSFT_DoTypeInfo(
  * place. This will cause a deliberate memory leak, but generally losing RAM for cycles is an acceptable
  * tradeoff here.
  */
-static struct list tlb_cache = LIST_INIT(tlb_cache);
+#define TLB_CACHE_HASH_SIZE 61
+
+static struct list tlb_cache[TLB_CACHE_HASH_SIZE];
 static CRITICAL_SECTION cache_section;
 static CRITICAL_SECTION_DEBUG cache_section_debug =
 {
@@ -2455,6 +2478,36 @@ static CRITICAL_SECTION_DEBUG cache_section_debug =
 };
 static CRITICAL_SECTION cache_section = { &cache_section_debug, -1, 0, 0, 0, 0 };
 
+/* returns the cache bucket of a typelib, the cache_section must be held */
+static struct list *get_tlb_cache_bucket(const WCHAR *path, INT index)
+{
+    unsigned int hash = index;
+
+    if (!tlb_cache[0].next)
+    {
+        int i;
+        for (i = 0; i < TLB_CACHE_HASH_SIZE; i++) list_init(&tlb_cache[i]);
+    }
+    while (*path) hash = hash * 31 + tolowerW(*path++);
+    return &tlb_cache[hash % TLB_CACHE_HASH_SIZE];
+}
+
+/* find a typelib in the cache and addref it, the cache_section must be held */
+static ITypeLibImpl *find_cached_typelib(const WCHAR *path, INT index)
+{
+    ITypeLibImpl *entry;
+
+    LIST_FOR_EACH_ENTRY(entry, get_tlb_cache_bucket(path, index), ITypeLibImpl, entry)
+    {
+        if (!strcmpiW(entry->path, path) && entry->index == index)
+        {
+            ITypeLib2_AddRef((ITypeLib2*)entry);
+            return entry;
+        }
+    }
+    return NULL;
+}
+
 
 typedef struct TLB_PEFile
 {
@@ -2910,18 +2963,14 @@ static HRESULT TLB_ReadTypeLib(LPCWSTR pszFileName, LPWSTR pszPath, UINT cchPath
 
     /* We look the path up in the typelib cache. If found, we just addref it, and return the pointer. */
     EnterCriticalSection(&cache_section);
-    LIST_FOR_EACH_ENTRY(entry, &tlb_cache, ITypeLibImpl, entry)
+    entry = find_cached_typelib(pszPath, index);
+    LeaveCriticalSection(&cache_section);
+    if (entry)
     {
-        if (!strcmpiW(entry->path, pszPath) && entry->index == index)
-        {
-            TRACE("cache hit\n");
-            *ppTypeLib = (ITypeLib2*)entry;
-            ITypeLib2_AddRef(*ppTypeLib);
-            LeaveCriticalSection(&cache_section);
-            return S_OK;
-        }
+        TRACE("cache hit\n");
+        *ppTypeLib = (ITypeLib2*)entry;
+        return S_OK;
     }
-    LeaveCriticalSection(&cache_section);
 
     /* now actually load and parse the typelib */
 
@@ -2961,9 +3010,16 @@ static HRESULT TLB_ReadTypeLib(LPCWSTR pszFileName, LPWSTR pszPath, UINT cchPath
 	/* We should really canonicalise the path here. */
         impl->index = index;
 
-        /* FIXME: check if it has added already in the meantime */
+        /* another thread may have loaded the same typelib in the meantime */
         EnterCriticalSection(&cache_section);
-        list_add_head(&tlb_cache, &impl->entry);
+        if ((entry = find_cached_typelib(pszPath, index)))
+        {
+            TRACE("already loaded by another thread\n");
+            ITypeLib2_Release(*ppTypeLib);
+            *ppTypeLib = (ITypeLib2*)entry;
+        }
+        else
+            list_add_head(get_tlb_cache_bucket(pszPath, index), &impl->entry);
         LeaveCriticalSection(&cache_section);
         ret = S_OK;
     } else
@@ -5134,6 +5190,7 @@ static void ITypeInfoImpl_Destroy(ITypeInfoImpl *This)
             SysFreeString(pFInfo->Entry);
         SysFreeString(pFInfo->HelpString);
         SysFreeString(pFInfo->Name);
+        heap_free(pFInfo->param_vts);
     }
     heap_free(This->funcdescs);
 
@@ -5161,6 +5218,7 @@ static void ITypeInfoImpl_Destroy(ITypeInfoImpl *This)
 
     TLB_FreeCustData(&This->custdata_list);
 
+    heap_free(This->name_hash);
     heap_free(This);
 }
 
@@ -5178,7 +5236,11 @@ static ULONG WINAPI ITypeInfo_fnRelease(ITypeInfo2 *iface)
         BOOL not_attached_to_typelib = This->not_attached_to_typelib;
         ITypeLib2_Release((ITypeLib2*)This->pTypeLib);
         if (not_attached_to_typelib)
+        {
+            if (!This->name_hash_shared)
+                heap_free(This->name_hash);
             heap_free(This);
+        }
         /* otherwise This will be freed when typelib is freed */
     }
 
@@ -5714,13 +5776,131 @@ static HRESULT WINAPI ITypeInfo_fnGetImplTypeFlags( ITypeInfo2 *iface,
  * Maps between member names and member IDs, and parameter names and
  * parameter IDs.
  */
+static UINT TLB_hash_member_name(const OLECHAR *name, UINT size)
+{
+    UINT hash = 0;
+
+    while (*name) hash = hash * 31 + tolowerW(*name++);
+    return hash % size;
+}
+
+/* names made of other characters than [A-Za-z0-9_] may compare equal
+ * in lstrcmpiW without having the same lowercase form */
+static BOOL TLB_is_hashable_name(const OLECHAR *name)
+{
+    for (; *name; name++)
+        if (*name >= 0x80 || !(isalnum(*name) || *name == '_')) return FALSE;
+    return TRUE;
+}
+
+static BOOL TLB_are_member_names_hashable(const ITypeInfoImpl *This)
+{
+    UINT i;
+
+    for (i = 0; i < This->TypeAttr.cFuncs; i++)
+        if (This->funcdescs[i].Name && !TLB_is_hashable_name(This->funcdescs[i].Name)) return FALSE;
+    for (i = 0; i < This->TypeAttr.cVars; i++)
+        if (This->vardescs[i].Name && !TLB_is_hashable_name(This->vardescs[i].Name)) return FALSE;
+    return TRUE;
+}
+
+static struct tlb_name_hash *TLB_get_name_hash(ITypeInfoImpl *This)
+{
+    struct tlb_name_hash *hash;
+    struct tlb_name_entry *entry;
+    UINT i, count = This->TypeAttr.cFuncs + This->TypeAttr.cVars;
+
+    if (This->name_hash) return This->name_hash;
+
+    /* if any member name can't be hashed, an empty index is stored and
+     * lookups fall back to the linear search */
+    if (!TLB_are_member_names_hashable(This))
+    {
+        hash = heap_alloc_zero(sizeof(*hash));
+        if (!hash) return NULL;
+        goto done;
+    }
+
+    hash = heap_alloc_zero(FIELD_OFFSET(struct tlb_name_hash, entries[count + 1]) +
+                           (count + 1) * sizeof(*hash->buckets));
+    if (!hash) return NULL;
+    hash->size = count + 1;
+    hash->buckets = (struct tlb_name_entry **)&hash->entries[count + 1];
+
+    /* functions are inserted before variables, and each one is appended to
+     * its bucket, so lookups find the same member as a linear search */
+    entry = hash->entries;
+    for (i = 0; i < This->TypeAttr.cFuncs; i++, entry++)
+    {
+        entry->func = &This->funcdescs[i];
+        entry->name = This->funcdescs[i].Name;
+    }
+    for (i = 0; i < This->TypeAttr.cVars; i++, entry++)
+    {
+        entry->var = &This->vardescs[i];
+        entry->name = This->vardescs[i].Name;
+    }
+    for (i = count; i > 0; i--)
+    {
+        struct tlb_name_entry **bucket;
+
+        entry = &hash->entries[i - 1];
+        if (!entry->name) continue;
+        bucket = &hash->buckets[TLB_hash_member_name(entry->name, hash->size)];
+        entry->next = *bucket;
+        *bucket = entry;
+    }
+
+done:
+    if (InterlockedCompareExchangePointer((void **)&This->name_hash, hash, NULL))
+        heap_free(hash);
+    return This->name_hash;
+}
+
+static void TLB_find_member_by_name(ITypeInfoImpl *This, const OLECHAR *name,
+        const TLBFuncDesc **func, const TLBVarDesc **var)
+{
+    struct tlb_name_hash *hash;
+    UINT fdc;
+
+    *func = NULL;
+    *var = NULL;
+
+    if (TLB_is_hashable_name(name) && (hash = TLB_get_name_hash(This)) && hash->size)
+    {
+        const struct tlb_name_entry *entry;
+
+        for (entry = hash->buckets[TLB_hash_member_name(name, hash->size)]; entry; entry = entry->next)
+        {
+            if (!lstrcmpiW(name, entry->name))
+            {
+                *func = entry->func;
+                *var = entry->var;
+                return;
+            }
+        }
+        return;
+    }
+
+    for (fdc = 0; fdc < This->TypeAttr.cFuncs; ++fdc)
+    {
+        if (!lstrcmpiW(name, This->funcdescs[fdc].Name))
+        {
+            *func = &This->funcdescs[fdc];
+            return;
+        }
+    }
+    *var = TLB_get_vardesc_by_name(This->vardescs, This->TypeAttr.cVars, name);
+}
+
 static HRESULT WINAPI ITypeInfo_fnGetIDsOfNames( ITypeInfo2 *iface,
         LPOLESTR  *rgszNames, UINT cNames, MEMBERID  *pMemId)
 {
     ITypeInfoImpl *This = (ITypeInfoImpl *)iface;
+    const TLBFuncDesc *pFDesc;
     const TLBVarDesc *pVDesc;
     HRESULT ret=S_OK;
-    UINT i, fdc;
+    UINT i;
 
     TRACE("(%p) Name %s cNames %d\n", This, debugstr_w(*rgszNames),
             cNames);
@@ -5729,25 +5909,22 @@ static HRESULT WINAPI ITypeInfo_fnGetIDsOfNames( ITypeInfo2 *iface,
     for (i = 0; i < cNames; i++)
         pMemId[i] = MEMBERID_NIL;
 
-    for (fdc = 0; fdc < This->TypeAttr.cFuncs; ++fdc) {
+    TLB_find_member_by_name(This, *rgszNames, &pFDesc, &pVDesc);
+    if (pFDesc) {
         int j;
-        const TLBFuncDesc *pFDesc = &This->funcdescs[fdc];
-        if(!lstrcmpiW(*rgszNames, pFDesc->Name)) {
-            if(cNames) *pMemId=pFDesc->funcdesc.memid;
-            for(i=1; i < cNames; i++){
-                for(j=0; j<pFDesc->funcdesc.cParams; j++)
-                    if(!lstrcmpiW(rgszNames[i],pFDesc->pParamDesc[j].Name))
-                            break;
-                if( j<pFDesc->funcdesc.cParams)
-                    pMemId[i]=j;
-                else
-                   ret=DISP_E_UNKNOWNNAME;
-            };
-            TRACE("-- 0x%08x\n", ret);
-            return ret;
-        }
+        if(cNames) *pMemId=pFDesc->funcdesc.memid;
+        for(i=1; i < cNames; i++){
+            for(j=0; j<pFDesc->funcdesc.cParams; j++)
+                if(!lstrcmpiW(rgszNames[i],pFDesc->pParamDesc[j].Name))
+                        break;
+            if( j<pFDesc->funcdesc.cParams)
+                pMemId[i]=j;
+            else
+               ret=DISP_E_UNKNOWNNAME;
+        };
+        TRACE("-- 0x%08x\n", ret);
+        return ret;
     }
-    pVDesc = TLB_get_vardesc_by_name(This->vardescs, This->TypeAttr.cVars, *rgszNames);
     if(pVDesc){
         if(cNames)
             *pMemId = pVDesc->vardesc.memid;
@@ -6297,6 +6474,38 @@ static inline BOOL func_restricted( const FUNCDESC *desc )
 #define INVBUF_GET_ARG_TYPE_ARRAY(buffer, params) \
     ((VARTYPE *)((char *)(buffer) + (sizeof(VARIANTARG) + sizeof(VARIANTARG) + sizeof(VARIANTARG *)) * (params)))
 
+/* the variant types of the parameters only depend on the type description,
+ * so they are computed once and reused by later Invoke calls */
+static HRESULT get_func_param_vts(ITypeInfo *tinfo, TLBFuncDesc *func, VARTYPE *vts)
+{
+    const FUNCDESC *func_desc = &func->funcdesc;
+    VARTYPE *cached;
+    HRESULT hres;
+    int i;
+
+    if (!func_desc->cParams) return S_OK;
+
+    if (!func->param_vts)
+    {
+        if (!(cached = heap_alloc_zero(func_desc->cParams * sizeof(*cached))))
+            return E_OUTOFMEMORY;
+        for (i = 0; i < func_desc->cParams; i++)
+        {
+            TYPEDESC *tdesc = &func_desc->lprgelemdescParam[i].tdesc;
+            hres = typedescvt_to_variantvt(tinfo, tdesc, &cached[i]);
+            if (FAILED(hres))
+            {
+                heap_free(cached);
+                return hres;
+            }
+        }
+        if (InterlockedCompareExchangePointer((void **)&func->param_vts, cached, NULL))
+            heap_free(cached);
+    }
+    memcpy(vts, func->param_vts, func_desc->cParams * sizeof(*vts));
+    return S_OK;
+}
+
 static HRESULT WINAPI ITypeInfo_fnInvoke(
     ITypeInfo2 *iface,
     VOID  *pIUnk,
@@ -6388,13 +6597,9 @@ static HRESULT WINAPI ITypeInfo_fnInvoke(
                 goto func_fail;
             }
 
-            for (i = 0; i < func_desc->cParams; i++)
-            {
-                TYPEDESC *tdesc = &func_desc->lprgelemdescParam[i].tdesc;
-                hres = typedescvt_to_variantvt((ITypeInfo *)iface, tdesc, &rgvt[i]);
-                if (FAILED(hres))
-                    goto func_fail;
-            }
+            hres = get_func_param_vts((ITypeInfo *)iface, (TLBFuncDesc *)pFuncInfo, rgvt);
+            if (FAILED(hres))
+                goto func_fail;
 
             TRACE("changing args\n");
             for (i = 0; i < func_desc->cParams; i++)
@@ -7020,6 +7225,10 @@ static HRESULT WINAPI ITypeInfo_fnGetRefTypeInfo(
 	   * not free its data structures when it is destroyed */
 	  pTypeInfoImpl->not_attached_to_typelib = TRUE;
 
+	  /* reuse the name index of the dispinterface if it has one already,
+	   * otherwise the copy builds and frees its own */
+	  pTypeInfoImpl->name_hash_shared = pTypeInfoImpl->name_hash != NULL;
+
 	  ITypeInfo_AddRef(*ppTInfo);
 
 	  result = S_OK;
@@ -113,6 +113,9 @@ typedef struct _RpcConnection_np
   HANDLE pipe;
   HANDLE listen_thread;
   BOOL listening;
+  char *read_buf;          /* rest of the last message read from the pipe */
+  unsigned int read_pos;
+  unsigned int read_len;
 } RpcConnection_np;
 
 static RpcConnection *rpcrt4_conn_np_alloc(void)
@@ -367,6 +370,8 @@ static void rpcrt4_conn_np_handoff(RpcConnection_np *old_npc, RpcConnection_np *
 
   new_npc->pipe = old_npc->pipe;
   new_npc->listen_thread = old_npc->listen_thread;
+  new_npc->read_pos = new_npc->read_len = 0;
+  old_npc->read_pos = old_npc->read_len = 0;
   old_npc->pipe = 0;
   old_npc->listen_thread = 0;
   old_npc->listening = FALSE;
@@ -417,6 +422,36 @@ static int rpcrt4_conn_np_read(RpcConnection *Connection,
   while (bytes_left)
   {
     DWORD bytes_read;
+
+    /* serve what is left of the previously read message first */
+    if (npc->read_pos < npc->read_len)
+    {
+        bytes_read = min(bytes_left, npc->read_len - npc->read_pos);
+        memcpy(buf, npc->read_buf + npc->read_pos, bytes_read);
+        npc->read_pos += bytes_read;
+        bytes_left -= bytes_read;
+        buf += bytes_read;
+        continue;
+    }
+
+    /* the receive path asks for the common header, the rest of the header
+     * and the body separately; pull a whole message off the pipe at once so
+     * that a fragment costs a single read instead of three */
+    if (bytes_left < RPC_MAX_PACKET_SIZE)
+    {
+        if (!npc->read_buf &&
+            !(npc->read_buf = HeapAlloc(GetProcessHeap(), 0, RPC_MAX_PACKET_SIZE)))
+            return -1;
+        npc->read_pos = npc->read_len = 0;
+        ret = ReadFile(npc->pipe, npc->read_buf, RPC_MAX_PACKET_SIZE, &bytes_read, NULL);
+        if (!ret && GetLastError() == ERROR_MORE_DATA)
+            ret = TRUE;
+        if (!ret || !bytes_read)
+            break;
+        npc->read_len = bytes_read;
+        continue;
+    }
+
     ret = ReadFile(npc->pipe, buf, bytes_left, &bytes_read, NULL);
     if (!ret && GetLastError() == ERROR_MORE_DATA)
         ret = TRUE;
@@ -460,6 +495,9 @@ static int rpcrt4_conn_np_close(RpcConnection *Connection)
     CloseHandle(npc->listen_thread);
     npc->listen_thread = 0;
   }
+  HeapFree(GetProcessHeap(), 0, npc->read_buf);
+  npc->read_buf = NULL;
+  npc->read_pos = npc->read_len = 0;
   return 0;
 }
 
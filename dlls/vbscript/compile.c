@@ -440,6 +440,99 @@ static HRESULT compile_binary_expression(compile_ctx_t *ctx, binary_expression_t
     return push_instr(ctx, op) ? S_OK : E_OUTOFMEMORY;
 }
 
+/* Returns the length of the string constant expr folds to, or -1 if it's not constant. */
+static int const_string_length(expression_t *expr)
+{
+    int left, right;
+
+    switch(expr->type) {
+    case EXPR_STRING:
+        return strlenW(((string_expression_t*)expr)->value);
+    case EXPR_BRACKETS:
+        return const_string_length(((unary_expression_t*)expr)->subexpr);
+    case EXPR_CONCAT:
+        left = const_string_length(((binary_expression_t*)expr)->left);
+        if(left == -1)
+            return -1;
+        right = const_string_length(((binary_expression_t*)expr)->right);
+        return right == -1 ? -1 : left+right;
+    default:
+        return -1;
+    }
+}
+
+static WCHAR *write_const_string(expression_t *expr, WCHAR *ptr)
+{
+    switch(expr->type) {
+    case EXPR_STRING: {
+        const WCHAR *str = ((string_expression_t*)expr)->value;
+        unsigned len = strlenW(str);
+
+        memcpy(ptr, str, len*sizeof(WCHAR));
+        return ptr+len;
+    }
+    case EXPR_BRACKETS:
+        return write_const_string(((unary_expression_t*)expr)->subexpr, ptr);
+    case EXPR_CONCAT:
+        ptr = write_const_string(((binary_expression_t*)expr)->left, ptr);
+        return write_const_string(((binary_expression_t*)expr)->right, ptr);
+    default:
+        assert(0);
+        return ptr;
+    }
+}
+
+static HRESULT compile_concat_expression(compile_ctx_t *ctx, binary_expression_t *expr)
+{
+    unsigned instr;
+    WCHAR *str;
+    int len;
+
+    len = const_string_length(&expr->expr);
+    if(len == -1)
+        return compile_binary_expression(ctx, expr, OP_concat);
+
+    str = compiler_alloc(ctx->code, (len+1)*sizeof(WCHAR));
+    if(!str)
+        return E_OUTOFMEMORY;
+    *write_const_string(&expr->expr, str) = 0;
+
+    instr = push_instr(ctx, OP_string);
+    if(!instr)
+        return E_OUTOFMEMORY;
+
+    instr_ptr(ctx, instr)->arg1.str = str;
+    return S_OK;
+}
+
+/* Negative numeric literals are parsed as negated positive ones, fold them back. */
+static HRESULT compile_neg_expression(compile_ctx_t *ctx, unary_expression_t *expr)
+{
+    switch(expr->subexpr->type) {
+    case EXPR_USHORT: {
+        LONG value = ((int_expression_t*)expr->subexpr)->value;
+
+        /* -(-32768) is not a short value */
+        if(value != -0x8000)
+            return push_instr_int(ctx, OP_short, -value);
+        break;
+    }
+    case EXPR_ULONG: {
+        LONG value = ((int_expression_t*)expr->subexpr)->value;
+
+        if(value != (LONG)0x80000000)
+            return push_instr_int(ctx, OP_long, -value);
+        break;
+    }
+    case EXPR_DOUBLE:
+        return push_instr_double(ctx, OP_double, -((double_expression_t*)expr->subexpr)->value);
+    default:
+        break;
+    }
+
+    return compile_unary_expression(ctx, expr, OP_neg);
+}
+
 static HRESULT compile_expression(compile_ctx_t *ctx, expression_t *expr)
 {
     switch(expr->type) {
@@ -452,7 +545,7 @@ static HRESULT compile_expression(compile_ctx_t *ctx, expression_t *expr)
     case EXPR_BRACKETS:
         return compile_expression(ctx, ((unary_expression_t*)expr)->subexpr);
     case EXPR_CONCAT:
-        return compile_binary_expression(ctx, (binary_expression_t*)expr, OP_concat);
+        return compile_concat_expression(ctx, (binary_expression_t*)expr);
     case EXPR_DIV:
         return compile_binary_expression(ctx, (binary_expression_t*)expr, OP_div);
     case EXPR_DOUBLE:
@@ -488,7 +581,7 @@ static HRESULT compile_expression(compile_ctx_t *ctx, expression_t *expr)
     case EXPR_MUL:
         return compile_binary_expression(ctx, (binary_expression_t*)expr, OP_mul);
     case EXPR_NEG:
-        return compile_unary_expression(ctx, (unary_expression_t*)expr, OP_neg);
+        return compile_neg_expression(ctx, (unary_expression_t*)expr);
     case EXPR_NEQUAL:
         return compile_binary_expression(ctx, (binary_expression_t*)expr, OP_nequal);
     case EXPR_NEW:
@@ -1200,6 +1293,64 @@ static void resolve_labels(compile_ctx_t *ctx, unsigned off)
     ctx->labels_cnt = 0;
 }
 
+/*
+ * Local variables and arguments are the first things lookup_identifier tries, so identifier
+ * references resolving to them may be bound to their slot at compile time. Slots are indexes
+ * to vars for non-negative values and to args otherwise (-1-index).
+ */
+static BOOL lookup_local_slot(function_t *func, const WCHAR *name, LONG *slot)
+{
+    unsigned i;
+
+    for(i=0; i < func->var_cnt; i++) {
+        if(!strcmpiW(func->vars[i].name, name)) {
+            *slot = i;
+            return TRUE;
+        }
+    }
+
+    for(i=0; i < func->arg_cnt; i++) {
+        if(!strcmpiW(func->args[i].name, name)) {
+            *slot = -1-(LONG)i;
+            return TRUE;
+        }
+    }
+
+    return FALSE;
+}
+
+static void resolve_local_slots(compile_ctx_t *ctx, function_t *func)
+{
+    BOOL has_ret_val;
+    instr_t *instr;
+    LONG slot;
+
+    /* Assignments to the function name store its return value instead. */
+    has_ret_val = func->type == FUNC_FUNCTION || func->type == FUNC_PROPGET || func->type == FUNC_DEFGET;
+
+    for(instr = ctx->code->instrs+func->code_off; instr < ctx->code->instrs+ctx->instr_cnt; instr++) {
+        switch(instr->op) {
+        case OP_icall:
+            if(!instr->arg2.uint && lookup_local_slot(func, instr->arg1.bstr, &slot)) {
+                instr->op = OP_local;
+                instr->arg2.lng = slot;
+            }
+            break;
+        case OP_assign_ident:
+        case OP_set_ident:
+            if(instr->arg2.uint || (has_ret_val && !strcmpiW(instr->arg1.bstr, func->name))
+               || !lookup_local_slot(func, instr->arg1.bstr, &slot))
+                break;
+
+            instr->op = instr->op == OP_assign_ident ? OP_assign_local : OP_set_local;
+            instr->arg2.lng = slot;
+            break;
+        default:
+            break;
+        }
+    }
+}
+
 static HRESULT compile_func(compile_ctx_t *ctx, statement_t *stat, function_t *func)
 {
     HRESULT hres;
@@ -1293,6 +1444,8 @@ static HRESULT compile_func(compile_ctx_t *ctx, statement_t *stat, function_t *f
         }
     }
 
+    if(func->type != FUNC_GLOBAL)
+        resolve_local_slots(ctx, func);
     return S_OK;
 }
 
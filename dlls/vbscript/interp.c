@@ -568,6 +568,34 @@ static HRESULT interp_icallv(exec_ctx_t *ctx)
     return do_icall(ctx, NULL);
 }
 
+/* Returns the variable bound to a slot by the compiler, see resolve_local_slots. */
+static VARIANT *get_local_var(exec_ctx_t *ctx, LONG slot)
+{
+    VARIANT *v;
+
+    if(slot >= 0) {
+        assert(slot < ctx->func->var_cnt);
+        v = ctx->vars+slot;
+    }else {
+        assert(-1-slot < ctx->func->arg_cnt);
+        v = ctx->args-1-slot;
+    }
+
+    return V_VT(v) == (VT_VARIANT|VT_BYREF) ? V_VARIANTREF(v) : v;
+}
+
+static HRESULT interp_local(exec_ctx_t *ctx)
+{
+    const LONG slot = ctx->instr->arg2.lng;
+    VARIANT v;
+
+    TRACE("%s\n", debugstr_w(ctx->instr->arg1.bstr));
+
+    V_VT(&v) = VT_BYREF|VT_VARIANT;
+    V_BYREF(&v) = get_local_var(ctx, slot);
+    return stack_push(ctx, &v);
+}
+
 static HRESULT do_mcall(exec_ctx_t *ctx, VARIANT *res)
 {
     const BSTR identifier = ctx->instr->arg1.bstr;
@@ -723,6 +751,44 @@ static HRESULT interp_set_ident(exec_ctx_t *ctx)
     return S_OK;
 }
 
+static HRESULT interp_assign_local(exec_ctx_t *ctx)
+{
+    const LONG slot = ctx->instr->arg2.lng;
+    HRESULT hres;
+
+    TRACE("%s\n", debugstr_w(ctx->instr->arg1.bstr));
+
+    hres = stack_assume_val(ctx, 0);
+    if(FAILED(hres))
+        return hres;
+
+    hres = VariantCopy(get_local_var(ctx, slot), stack_top(ctx, 0));
+    if(FAILED(hres))
+        return hres;
+
+    stack_popn(ctx, 1);
+    return S_OK;
+}
+
+static HRESULT interp_set_local(exec_ctx_t *ctx)
+{
+    const LONG slot = ctx->instr->arg2.lng;
+    HRESULT hres;
+
+    TRACE("%s\n", debugstr_w(ctx->instr->arg1.bstr));
+
+    hres = stack_assume_disp(ctx, 0, NULL);
+    if(FAILED(hres))
+        return hres;
+
+    hres = VariantCopy(get_local_var(ctx, slot), stack_top(ctx, 0));
+    if(FAILED(hres))
+        return hres;
+
+    stack_popn(ctx, 1);
+    return S_OK;
+}
+
 static HRESULT interp_assign_member(exec_ctx_t *ctx)
 {
     BSTR identifier = ctx->instr->arg1.bstr;
@@ -82,680 +82,304 @@ static inline FormatConverter *impl_from_IWICFormatConverter(IWICFormatConverter
     return CONTAINING_RECORD(iface, FormatConverter, IWICFormatConverter_iface);
 }
 
-static HRESULT copypixels_to_32bppBGRA(struct FormatConverter *This, const WICRect *prc,
-    UINT cbStride, UINT cbBufferSize, BYTE *pbBuffer, enum pixelformat source_format)
+/* Row converters to 32bppBGRA. Each source pixel is read before its
+ * destination pixel is written, and formats narrower than 32 bits are
+ * processed from right to left, so rows can be expanded in place. */
+typedef void (*convert_row_func)(const BYTE *src, DWORD *dst, UINT width, UINT bpp,
+    const WICColor *colors);
+
+static void convert_row_indexed(const BYTE *src, DWORD *dst, UINT width, UINT bpp,
+    const WICColor *colors)
 {
-    switch (source_format)
-    {
-    case format_1bppIndexed:
-    case format_BlackWhite:
-        if (prc)
-        {
-            HRESULT res;
-            UINT x, y;
-            BYTE *srcdata;
-            UINT srcstride, srcdatasize;
-            const BYTE *srcrow;
-            const BYTE *srcbyte;
-            BYTE *dstrow;
-            DWORD *dstpixel;
-            WICColor colors[2];
-            IWICPalette *palette;
-            UINT actualcolors;
-
-            res = PaletteImpl_Create(&palette);
-            if (FAILED(res)) return res;
-
-            if (source_format == format_1bppIndexed)
-                res = IWICBitmapSource_CopyPalette(This->source, palette);
-            else
-                res = IWICPalette_InitializePredefined(palette, WICBitmapPaletteTypeFixedBW, FALSE);
-
-            if (SUCCEEDED(res))
-                res = IWICPalette_GetColors(palette, 2, colors, &actualcolors);
-
-            IWICPalette_Release(palette);
-            if (FAILED(res)) return res;
-
-            srcstride = (prc->Width+7)/8;
-            srcdatasize = srcstride * prc->Height;
-
-            srcdata = HeapAlloc(GetProcessHeap(), 0, srcdatasize);
-            if (!srcdata) return E_OUTOFMEMORY;
-
-            res = IWICBitmapSource_CopyPixels(This->source, prc, srcstride, srcdatasize, srcdata);
-
-            if (SUCCEEDED(res))
-            {
-                srcrow = srcdata;
-                dstrow = pbBuffer;
-                for (y=0; y<prc->Height; y++) {
-                    srcbyte = srcrow;
-                    dstpixel=(DWORD*)dstrow;
-                    for (x=0; x<prc->Width; x+=8) {
-                        BYTE srcval;
-                        srcval=*srcbyte++;
-                        *dstpixel++ = colors[srcval>>7&1];
-                        if (x+1 < prc->Width) *dstpixel++ = colors[srcval>>6&1];
-                        if (x+2 < prc->Width) *dstpixel++ = colors[srcval>>5&1];
-                        if (x+3 < prc->Width) *dstpixel++ = colors[srcval>>4&1];
-                        if (x+4 < prc->Width) *dstpixel++ = colors[srcval>>3&1];
-                        if (x+5 < prc->Width) *dstpixel++ = colors[srcval>>2&1];
-                        if (x+6 < prc->Width) *dstpixel++ = colors[srcval>>1&1];
-                        if (x+7 < prc->Width) *dstpixel++ = colors[srcval&1];
-                    }
-                    srcrow += srcstride;
-                    dstrow += cbStride;
-                }
-            }
-
-            HeapFree(GetProcessHeap(), 0, srcdata);
-
-            return res;
-        }
-        return S_OK;
-    case format_2bppIndexed:
-    case format_2bppGray:
-        if (prc)
-        {
-            HRESULT res;
-            UINT x, y;
-            BYTE *srcdata;
-            UINT srcstride, srcdatasize;
-            const BYTE *srcrow;
-            const BYTE *srcbyte;
-            BYTE *dstrow;
-            DWORD *dstpixel;
-            WICColor colors[4];
-            IWICPalette *palette;
-            UINT actualcolors;
-
-            res = PaletteImpl_Create(&palette);
-            if (FAILED(res)) return res;
+    UINT x, bit, mask = (1 << bpp) - 1;
 
-            if (source_format == format_2bppIndexed)
-                res = IWICBitmapSource_CopyPalette(This->source, palette);
-            else
-                res = IWICPalette_InitializePredefined(palette, WICBitmapPaletteTypeFixedGray4, FALSE);
-
-            if (SUCCEEDED(res))
-                res = IWICPalette_GetColors(palette, 4, colors, &actualcolors);
-
-            IWICPalette_Release(palette);
-            if (FAILED(res)) return res;
-
-            srcstride = (prc->Width+3)/4;
-            srcdatasize = srcstride * prc->Height;
-
-            srcdata = HeapAlloc(GetProcessHeap(), 0, srcdatasize);
-            if (!srcdata) return E_OUTOFMEMORY;
-
-            res = IWICBitmapSource_CopyPixels(This->source, prc, srcstride, srcdatasize, srcdata);
-
-            if (SUCCEEDED(res))
-            {
-                srcrow = srcdata;
-                dstrow = pbBuffer;
-                for (y=0; y<prc->Height; y++) {
-                    srcbyte = srcrow;
-                    dstpixel=(DWORD*)dstrow;
-                    for (x=0; x<prc->Width; x+=4) {
-                        BYTE srcval;
-                        srcval=*srcbyte++;
-                        *dstpixel++ = colors[srcval>>6];
-                        if (x+1 < prc->Width) *dstpixel++ = colors[srcval>>4&0x3];
-                        if (x+2 < prc->Width) *dstpixel++ = colors[srcval>>2&0x3];
-                        if (x+1 < prc->Width) *dstpixel++ = colors[srcval&0x3];
-                    }
-                    srcrow += srcstride;
-                    dstrow += cbStride;
-                }
-            }
-
-            HeapFree(GetProcessHeap(), 0, srcdata);
-
-            return res;
-        }
-        return S_OK;
-    case format_4bppIndexed:
-    case format_4bppGray:
-        if (prc)
-        {
-            HRESULT res;
-            UINT x, y;
-            BYTE *srcdata;
-            UINT srcstride, srcdatasize;
-            const BYTE *srcrow;
-            const BYTE *srcbyte;
-            BYTE *dstrow;
-            DWORD *dstpixel;
-            WICColor colors[16];
-            IWICPalette *palette;
-            UINT actualcolors;
+    for (x=width; x--; )
+    {
+        bit = x * bpp;
+        dst[x] = colors[(src[bit / 8] >> (8 - bpp - bit % 8)) & mask];
+    }
+}
 
-            res = PaletteImpl_Create(&palette);
-            if (FAILED(res)) return res;
+static void convert_row_8bppGray(const BYTE *src, DWORD *dst, UINT width, UINT bpp,
+    const WICColor *colors)
+{
+    UINT x;
 
-            if (source_format == format_4bppIndexed)
-                res = IWICBitmapSource_CopyPalette(This->source, palette);
-            else
-                res = IWICPalette_InitializePredefined(palette, WICBitmapPaletteTypeFixedGray16, FALSE);
+    for (x=width; x--; )
+    {
+        BYTE gray = src[x];
+        dst[x] = 0xff000000|(gray<<16)|(gray<<8)|gray;
+    }
+}
 
-            if (SUCCEEDED(res))
-                res = IWICPalette_GetColors(palette, 16, colors, &actualcolors);
+static void convert_row_16bppGray(const BYTE *src, DWORD *dst, UINT width, UINT bpp,
+    const WICColor *colors)
+{
+    UINT x;
 
-            IWICPalette_Release(palette);
-            if (FAILED(res)) return res;
+    for (x=width; x--; )
+    {
+        BYTE gray = src[x*2];
+        dst[x] = 0xff000000|(gray<<16)|(gray<<8)|gray;
+    }
+}
 
-            srcstride = (prc->Width+1)/2;
-            srcdatasize = srcstride * prc->Height;
+static void convert_row_16bppBGR555(const BYTE *src, DWORD *dst, UINT width, UINT bpp,
+    const WICColor *colors)
+{
+    const WORD *srcpixel = (const WORD*)src;
+    UINT x;
 
-            srcdata = HeapAlloc(GetProcessHeap(), 0, srcdatasize);
-            if (!srcdata) return E_OUTOFMEMORY;
+    for (x=width; x--; )
+    {
+        WORD srcval = srcpixel[x];
+        dst[x]=0xff000000 | /* constant 255 alpha */
+               ((srcval << 9) & 0xf80000) | /* r */
+               ((srcval << 4) & 0x070000) | /* r - 3 bits */
+               ((srcval << 6) & 0x00f800) | /* g */
+               ((srcval << 1) & 0x000700) | /* g - 3 bits */
+               ((srcval << 3) & 0x0000f8) | /* b */
+               ((srcval >> 2) & 0x000007);  /* b - 3 bits */
+    }
+}
 
-            res = IWICBitmapSource_CopyPixels(This->source, prc, srcstride, srcdatasize, srcdata);
+static void convert_row_16bppBGR565(const BYTE *src, DWORD *dst, UINT width, UINT bpp,
+    const WICColor *colors)
+{
+    const WORD *srcpixel = (const WORD*)src;
+    UINT x;
 
-            if (SUCCEEDED(res))
-            {
-                srcrow = srcdata;
-                dstrow = pbBuffer;
-                for (y=0; y<prc->Height; y++) {
-                    srcbyte = srcrow;
-                    dstpixel=(DWORD*)dstrow;
-                    for (x=0; x<prc->Width; x+=2) {
-                        BYTE srcval;
-                        srcval=*srcbyte++;
-                        *dstpixel++ = colors[srcval>>4];
-                        if (x+1 < prc->Width) *dstpixel++ = colors[srcval&0xf];
-                    }
-                    srcrow += srcstride;
-                    dstrow += cbStride;
-                }
-            }
+    for (x=width; x--; )
+    {
+        WORD srcval = srcpixel[x];
+        dst[x]=0xff000000 | /* constant 255 alpha */
+               ((srcval << 8) & 0xf80000) | /* r */
+               ((srcval << 3) & 0x070000) | /* r - 3 bits */
+               ((srcval << 5) & 0x00fc00) | /* g */
+               ((srcval >> 1) & 0x000300) | /* g - 2 bits */
+               ((srcval << 3) & 0x0000f8) | /* b */
+               ((srcval >> 2) & 0x000007);  /* b - 3 bits */
+    }
+}
 
-            HeapFree(GetProcessHeap(), 0, srcdata);
+static void convert_row_16bppBGRA5551(const BYTE *src, DWORD *dst, UINT width, UINT bpp,
+    const WICColor *colors)
+{
+    const WORD *srcpixel = (const WORD*)src;
+    UINT x;
 
-            return res;
-        }
-        return S_OK;
-    case format_8bppGray:
-        if (prc)
-        {
-            HRESULT res;
-            UINT x, y;
-            BYTE *srcdata;
-            UINT srcstride, srcdatasize;
-            const BYTE *srcrow;
-            const BYTE *srcbyte;
-            BYTE *dstrow;
-            DWORD *dstpixel;
+    for (x=width; x--; )
+    {
+        WORD srcval = srcpixel[x];
+        dst[x]=((srcval & 0x8000) ? 0xff000000 : 0) | /* alpha */
+               ((srcval << 9) & 0xf80000) | /* r */
+               ((srcval << 4) & 0x070000) | /* r - 3 bits */
+               ((srcval << 6) & 0x00f800) | /* g */
+               ((srcval << 1) & 0x000700) | /* g - 3 bits */
+               ((srcval << 3) & 0x0000f8) | /* b */
+               ((srcval >> 2) & 0x000007);  /* b - 3 bits */
+    }
+}
 
-            srcstride = prc->Width;
-            srcdatasize = srcstride * prc->Height;
+static void convert_row_24bppBGR(const BYTE *src, DWORD *dst, UINT width, UINT bpp,
+    const WICColor *colors)
+{
+    UINT x;
 
-            srcdata = HeapAlloc(GetProcessHeap(), 0, srcdatasize);
-            if (!srcdata) return E_OUTOFMEMORY;
+    for (x=width; x--; )
+    {
+        const BYTE *srcpixel = src + x*3;
+        dst[x] = 0xff000000|(srcpixel[2]<<16)|(srcpixel[1]<<8)|srcpixel[0];
+    }
+}
 
-            res = IWICBitmapSource_CopyPixels(This->source, prc, srcstride, srcdatasize, srcdata);
+static void convert_row_32bppBGR(const BYTE *src, DWORD *dst, UINT width, UINT bpp,
+    const WICColor *colors)
+{
+    UINT x;
 
-            if (SUCCEEDED(res))
-            {
-                srcrow = srcdata;
-                dstrow = pbBuffer;
-                for (y=0; y<prc->Height; y++) {
-                    srcbyte = srcrow;
-                    dstpixel=(DWORD*)dstrow;
-                    for (x=0; x<prc->Width; x++)
-                    {
-                        *dstpixel++ = 0xff000000|(*srcbyte<<16)|(*srcbyte<<8)|*srcbyte;
-                        srcbyte++;
-                    }
-                    srcrow += srcstride;
-                    dstrow += cbStride;
-                }
-            }
+    /* set all alpha values to 255 */
+    for (x=0; x<width; x++)
+        dst[x] = ((const DWORD*)src)[x] | 0xff000000;
+}
 
-            HeapFree(GetProcessHeap(), 0, srcdata);
+static void convert_row_32bppPBGRA(const BYTE *src, DWORD *dst, UINT width, UINT bpp,
+    const WICColor *colors)
+{
+    UINT x;
 
-            return res;
-        }
-        return S_OK;
-    case format_8bppIndexed:
-        if (prc)
+    for (x=0; x<width; x++)
+    {
+        const BYTE *srcpixel = src + x*4;
+        BYTE blue = srcpixel[0], green = srcpixel[1], red = srcpixel[2], alpha = srcpixel[3];
+        if (alpha != 0 && alpha != 255)
         {
-            HRESULT res;
-            UINT x, y;
-            BYTE *srcdata;
-            UINT srcstride, srcdatasize;
-            const BYTE *srcrow;
-            const BYTE *srcbyte;
-            BYTE *dstrow;
-            DWORD *dstpixel;
-            WICColor colors[256];
-            IWICPalette *palette;
-            UINT actualcolors;
-
-            res = PaletteImpl_Create(&palette);
-            if (FAILED(res)) return res;
-
-            res = IWICBitmapSource_CopyPalette(This->source, palette);
-            if (SUCCEEDED(res))
-                res = IWICPalette_GetColors(palette, 256, colors, &actualcolors);
-
-            IWICPalette_Release(palette);
-
-            if (FAILED(res)) return res;
-
-            srcstride = prc->Width;
-            srcdatasize = srcstride * prc->Height;
-
-            srcdata = HeapAlloc(GetProcessHeap(), 0, srcdatasize);
-            if (!srcdata) return E_OUTOFMEMORY;
-
-            res = IWICBitmapSource_CopyPixels(This->source, prc, srcstride, srcdatasize, srcdata);
-
-            if (SUCCEEDED(res))
-            {
-                srcrow = srcdata;
-                dstrow = pbBuffer;
-                for (y=0; y<prc->Height; y++) {
-                    srcbyte = srcrow;
-                    dstpixel=(DWORD*)dstrow;
-                    for (x=0; x<prc->Width; x++)
-                        *dstpixel++ = colors[*srcbyte++];
-                    srcrow += srcstride;
-                    dstrow += cbStride;
-                }
-            }
-
-            HeapFree(GetProcessHeap(), 0, srcdata);
-
-            return res;
+            blue = blue * 255 / alpha;
+            green = green * 255 / alpha;
+            red = red * 255 / alpha;
         }
-        return S_OK;
-    case format_16bppGray:
-        if (prc)
-        {
-            HRESULT res;
-            UINT x, y;
-            BYTE *srcdata;
-            UINT srcstride, srcdatasize;
-            const BYTE *srcrow;
-            const BYTE *srcbyte;
-            BYTE *dstrow;
-            DWORD *dstpixel;
-
-            srcstride = prc->Width * 2;
-            srcdatasize = srcstride * prc->Height;
+        dst[x] = ((DWORD)alpha<<24)|(red<<16)|(green<<8)|blue;
+    }
+}
 
-            srcdata = HeapAlloc(GetProcessHeap(), 0, srcdatasize);
-            if (!srcdata) return E_OUTOFMEMORY;
+static void convert_row_48bppRGB(const BYTE *src, DWORD *dst, UINT width, UINT bpp,
+    const WICColor *colors)
+{
+    UINT x;
 
-            res = IWICBitmapSource_CopyPixels(This->source, prc, srcstride, srcdatasize, srcdata);
+    for (x=0; x<width; x++)
+    {
+        const BYTE *srcpixel = src + x*6;
+        dst[x] = 0xff000000|(srcpixel[0]<<16)|(srcpixel[2]<<8)|srcpixel[4];
+    }
+}
 
-            if (SUCCEEDED(res))
-            {
-                srcrow = srcdata;
-                dstrow = pbBuffer;
-                for (y=0; y<prc->Height; y++) {
-                    srcbyte = srcrow;
-                    dstpixel=(DWORD*)dstrow;
-                    for (x=0; x<prc->Width; x++)
-                    {
-                        *dstpixel++ = 0xff000000|(*srcbyte<<16)|(*srcbyte<<8)|*srcbyte;
-                        srcbyte+=2;
-                    }
-                    srcrow += srcstride;
-                    dstrow += cbStride;
-                }
-            }
+static void convert_row_64bppRGBA(const BYTE *src, DWORD *dst, UINT width, UINT bpp,
+    const WICColor *colors)
+{
+    UINT x;
 
-            HeapFree(GetProcessHeap(), 0, srcdata);
+    for (x=0; x<width; x++)
+    {
+        const BYTE *srcpixel = src + x*8;
+        dst[x] = ((DWORD)srcpixel[6]<<24)|(srcpixel[0]<<16)|(srcpixel[2]<<8)|srcpixel[4];
+    }
+}
 
-            return res;
-        }
-        return S_OK;
-    case format_16bppBGR555:
-        if (prc)
-        {
-            HRESULT res;
-            UINT x, y;
-            BYTE *srcdata;
-            UINT srcstride, srcdatasize;
-            const BYTE *srcrow;
-            const WORD *srcpixel;
-            BYTE *dstrow;
-            DWORD *dstpixel;
+static void convert_row_32bppCMYK(const BYTE *src, DWORD *dst, UINT width, UINT bpp,
+    const WICColor *colors)
+{
+    UINT x;
 
-            srcstride = 2 * prc->Width;
-            srcdatasize = srcstride * prc->Height;
+    for (x=0; x<width; x++)
+    {
+        const BYTE *pixel = src + x*4;
+        BYTE c=pixel[0], m=pixel[1], y=pixel[2], k=pixel[3];
+        dst[x] = 0xff000000 | /* alpha */
+                 ((255-c)*(255-k)/255) << 16 | /* red */
+                 ((255-m)*(255-k)/255) << 8 | /* green */
+                 ((255-y)*(255-k)/255); /* blue */
+    }
+}
 
-            srcdata = HeapAlloc(GetProcessHeap(), 0, srcdatasize);
-            if (!srcdata) return E_OUTOFMEMORY;
+struct bgra_conversion {
+    UINT bpp;
+    BOOL indexed; /* uses the palette of the source */
+    WICBitmapPaletteType palette_type; /* uses a predefined palette, if not custom */
+    convert_row_func convert_row;
+};
 
-            res = IWICBitmapSource_CopyPixels(This->source, prc, srcstride, srcdatasize, srcdata);
+/* indexed by enum pixelformat */
+static const struct bgra_conversion bgra_conversions[] = {
+    {1, TRUE, WICBitmapPaletteTypeCustom, convert_row_indexed}, /* 1bppIndexed */
+    {2, TRUE, WICBitmapPaletteTypeCustom, convert_row_indexed}, /* 2bppIndexed */
+    {4, TRUE, WICBitmapPaletteTypeCustom, convert_row_indexed}, /* 4bppIndexed */
+    {8, TRUE, WICBitmapPaletteTypeCustom, convert_row_indexed}, /* 8bppIndexed */
+    {1, FALSE, WICBitmapPaletteTypeFixedBW, convert_row_indexed}, /* BlackWhite */
+    {2, FALSE, WICBitmapPaletteTypeFixedGray4, convert_row_indexed}, /* 2bppGray */
+    {4, FALSE, WICBitmapPaletteTypeFixedGray16, convert_row_indexed}, /* 4bppGray */
+    {8, FALSE, WICBitmapPaletteTypeCustom, convert_row_8bppGray},
+    {16, FALSE, WICBitmapPaletteTypeCustom, convert_row_16bppGray},
+    {16, FALSE, WICBitmapPaletteTypeCustom, convert_row_16bppBGR555},
+    {16, FALSE, WICBitmapPaletteTypeCustom, convert_row_16bppBGR565},
+    {16, FALSE, WICBitmapPaletteTypeCustom, convert_row_16bppBGRA5551},
+    {24, FALSE, WICBitmapPaletteTypeCustom, convert_row_24bppBGR},
+    {32, FALSE, WICBitmapPaletteTypeCustom, convert_row_32bppBGR},
+    {32, FALSE, WICBitmapPaletteTypeCustom, NULL}, /* 32bppBGRA */
+    {32, FALSE, WICBitmapPaletteTypeCustom, convert_row_32bppPBGRA},
+    {48, FALSE, WICBitmapPaletteTypeCustom, convert_row_48bppRGB},
+    {64, FALSE, WICBitmapPaletteTypeCustom, convert_row_64bppRGBA},
+    {32, FALSE, WICBitmapPaletteTypeCustom, convert_row_32bppCMYK},
+};
 
-            if (SUCCEEDED(res))
-            {
-                srcrow = srcdata;
-                dstrow = pbBuffer;
-                for (y=0; y<prc->Height; y++) {
-                    srcpixel=(const WORD*)srcrow;
-                    dstpixel=(DWORD*)dstrow;
-                    for (x=0; x<prc->Width; x++) {
-                        WORD srcval;
-                        srcval=*srcpixel++;
-                        *dstpixel++=0xff000000 | /* constant 255 alpha */
-                                    ((srcval << 9) & 0xf80000) | /* r */
-                                    ((srcval << 4) & 0x070000) | /* r - 3 bits */
-                                    ((srcval << 6) & 0x00f800) | /* g */
-                                    ((srcval << 1) & 0x000700) | /* g - 3 bits */
-                                    ((srcval << 3) & 0x0000f8) | /* b */
-                                    ((srcval >> 2) & 0x000007);  /* b - 3 bits */
-                    }
-                    srcrow += srcstride;
-                    dstrow += cbStride;
-                }
-            }
+/* Formats wider than the destination are converted through a buffer of at
+ * most this size, a strip of rows at a time. */
+#define CONVERT_STRIP_SIZE 0x10000
 
-            HeapFree(GetProcessHeap(), 0, srcdata);
+static HRESULT copypixels_to_32bppBGRA(struct FormatConverter *This, const WICRect *prc,
+    UINT cbStride, UINT cbBufferSize, BYTE *pbBuffer, enum pixelformat source_format)
+{
+    const struct bgra_conversion *conversion = &bgra_conversions[source_format];
+    WICColor colors[256];
+    HRESULT res = S_OK;
+    UINT y;
 
-            return res;
-        }
+    if (!prc)
         return S_OK;
-    case format_16bppBGR565:
-        if (prc)
-        {
-            HRESULT res;
-            UINT x, y;
-            BYTE *srcdata;
-            UINT srcstride, srcdatasize;
-            const BYTE *srcrow;
-            const WORD *srcpixel;
-            BYTE *dstrow;
-            DWORD *dstpixel;
-
-            srcstride = 2 * prc->Width;
-            srcdatasize = srcstride * prc->Height;
-
-            srcdata = HeapAlloc(GetProcessHeap(), 0, srcdatasize);
-            if (!srcdata) return E_OUTOFMEMORY;
 
-            res = IWICBitmapSource_CopyPixels(This->source, prc, srcstride, srcdatasize, srcdata);
+    if (!conversion->convert_row)
+        return IWICBitmapSource_CopyPixels(This->source, prc, cbStride, cbBufferSize, pbBuffer);
 
-            if (SUCCEEDED(res))
-            {
-                srcrow = srcdata;
-                dstrow = pbBuffer;
-                for (y=0; y<prc->Height; y++) {
-                    srcpixel=(const WORD*)srcrow;
-                    dstpixel=(DWORD*)dstrow;
-                    for (x=0; x<prc->Width; x++) {
-                        WORD srcval;
-                        srcval=*srcpixel++;
-                        *dstpixel++=0xff000000 | /* constant 255 alpha */
-                                    ((srcval << 8) & 0xf80000) | /* r */
-                                    ((srcval << 3) & 0x070000) | /* r - 3 bits */
-                                    ((srcval << 5) & 0x00fc00) | /* g */
-                                    ((srcval >> 1) & 0x000300) | /* g - 2 bits */
-                                    ((srcval << 3) & 0x0000f8) | /* b */
-                                    ((srcval >> 2) & 0x000007);  /* b - 3 bits */
-                    }
-                    srcrow += srcstride;
-                    dstrow += cbStride;
-                }
-            }
-
-            HeapFree(GetProcessHeap(), 0, srcdata);
-
-            return res;
-        }
+    if (prc->Width <= 0 || prc->Height <= 0)
         return S_OK;
-    case format_16bppBGRA5551:
-        if (prc)
-        {
-            HRESULT res;
-            UINT x, y;
-            BYTE *srcdata;
-            UINT srcstride, srcdatasize;
-            const BYTE *srcrow;
-            const WORD *srcpixel;
-            BYTE *dstrow;
-            DWORD *dstpixel;
-
-            srcstride = 2 * prc->Width;
-            srcdatasize = srcstride * prc->Height;
-
-            srcdata = HeapAlloc(GetProcessHeap(), 0, srcdatasize);
-            if (!srcdata) return E_OUTOFMEMORY;
-
-            res = IWICBitmapSource_CopyPixels(This->source, prc, srcstride, srcdatasize, srcdata);
-
-            if (SUCCEEDED(res))
-            {
-                srcrow = srcdata;
-                dstrow = pbBuffer;
-                for (y=0; y<prc->Height; y++) {
-                    srcpixel=(const WORD*)srcrow;
-                    dstpixel=(DWORD*)dstrow;
-                    for (x=0; x<prc->Width; x++) {
-                        WORD srcval;
-                        srcval=*srcpixel++;
-                        *dstpixel++=((srcval & 0x8000) ? 0xff000000 : 0) | /* alpha */
-                                    ((srcval << 9) & 0xf80000) | /* r */
-                                    ((srcval << 4) & 0x070000) | /* r - 3 bits */
-                                    ((srcval << 6) & 0x00f800) | /* g */
-                                    ((srcval << 1) & 0x000700) | /* g - 3 bits */
-                                    ((srcval << 3) & 0x0000f8) | /* b */
-                                    ((srcval >> 2) & 0x000007);  /* b - 3 bits */
-                    }
-                    srcrow += srcstride;
-                    dstrow += cbStride;
-                }
-            }
 
-            HeapFree(GetProcessHeap(), 0, srcdata);
+    if (cbStride < 4 * prc->Width || cbStride * (prc->Height-1) + 4 * prc->Width > cbBufferSize)
+        return E_INVALIDARG;
 
-            return res;
-        }
-        return S_OK;
-    case format_24bppBGR:
-        if (prc)
-        {
-            HRESULT res;
-            UINT x, y;
-            BYTE *srcdata;
-            UINT srcstride, srcdatasize;
-            const BYTE *srcrow;
-            const BYTE *srcpixel;
-            BYTE *dstrow;
-            BYTE *dstpixel;
-
-            srcstride = 3 * prc->Width;
-            srcdatasize = srcstride * prc->Height;
+    if (conversion->indexed || conversion->palette_type != WICBitmapPaletteTypeCustom)
+    {
+        IWICPalette *palette;
+        UINT actualcolors;
 
-            srcdata = HeapAlloc(GetProcessHeap(), 0, srcdatasize);
-            if (!srcdata) return E_OUTOFMEMORY;
+        memset(colors, 0, sizeof(colors));
 
-            res = IWICBitmapSource_CopyPixels(This->source, prc, srcstride, srcdatasize, srcdata);
+        res = PaletteImpl_Create(&palette);
+        if (FAILED(res)) return res;
 
-            if (SUCCEEDED(res))
-            {
-                srcrow = srcdata;
-                dstrow = pbBuffer;
-                for (y=0; y<prc->Height; y++) {
-                    srcpixel=srcrow;
-                    dstpixel=dstrow;
-                    for (x=0; x<prc->Width; x++) {
-                        *dstpixel++=*srcpixel++; /* blue */
-                        *dstpixel++=*srcpixel++; /* green */
-                        *dstpixel++=*srcpixel++; /* red */
-                        *dstpixel++=255; /* alpha */
-                    }
-                    srcrow += srcstride;
-                    dstrow += cbStride;
-                }
-            }
+        if (conversion->indexed)
+            res = IWICBitmapSource_CopyPalette(This->source, palette);
+        else
+            res = IWICPalette_InitializePredefined(palette, conversion->palette_type, FALSE);
 
-            HeapFree(GetProcessHeap(), 0, srcdata);
+        if (SUCCEEDED(res))
+            res = IWICPalette_GetColors(palette, 1 << conversion->bpp, colors, &actualcolors);
 
-            return res;
-        }
-        return S_OK;
-    case format_32bppBGR:
-        if (prc)
-        {
-            HRESULT res;
-            UINT x, y;
+        IWICPalette_Release(palette);
+        if (FAILED(res)) return res;
+    }
 
-            res = IWICBitmapSource_CopyPixels(This->source, prc, cbStride, cbBufferSize, pbBuffer);
-            if (FAILED(res)) return res;
+    if (conversion->bpp <= 32)
+    {
+        /* read the source pixels into the destination and expand them in place */
+        res = IWICBitmapSource_CopyPixels(This->source, prc, cbStride, cbBufferSize, pbBuffer);
+        if (FAILED(res)) return res;
 
-            /* set all alpha values to 255 */
-            for (y=0; y<prc->Height; y++)
-                for (x=0; x<prc->Width; x++)
-                    pbBuffer[cbStride*y+4*x+3] = 0xff;
-        }
-        return S_OK;
-    case format_32bppBGRA:
-        if (prc)
-            return IWICBitmapSource_CopyPixels(This->source, prc, cbStride, cbBufferSize, pbBuffer);
-        return S_OK;
-    case format_32bppPBGRA:
-        if (prc)
+        for (y=0; y<prc->Height; y++)
         {
-            HRESULT res;
-            UINT x, y;
-
-            res = IWICBitmapSource_CopyPixels(This->source, prc, cbStride, cbBufferSize, pbBuffer);
-            if (FAILED(res)) return res;
-
-            for (y=0; y<prc->Height; y++)
-                for (x=0; x<prc->Width; x++)
-                {
-                    BYTE alpha = pbBuffer[cbStride*y+4*x+3];
-                    if (alpha != 0 && alpha != 255)
-                    {
-                        pbBuffer[cbStride*y+4*x] = pbBuffer[cbStride*y+4*x] * 255 / alpha;
-                        pbBuffer[cbStride*y+4*x+1] = pbBuffer[cbStride*y+4*x+1] * 255 / alpha;
-                        pbBuffer[cbStride*y+4*x+2] = pbBuffer[cbStride*y+4*x+2] * 255 / alpha;
-                    }
-                }
+            BYTE *row = pbBuffer + cbStride * y;
+            conversion->convert_row(row, (DWORD*)row, prc->Width, conversion->bpp, colors);
         }
-        return S_OK;
-    case format_48bppRGB:
-        if (prc)
-        {
-            HRESULT res;
-            UINT x, y;
-            BYTE *srcdata;
-            UINT srcstride, srcdatasize;
-            const BYTE *srcrow;
-            const BYTE *srcpixel;
-            BYTE *dstrow;
-            DWORD *dstpixel;
-
-            srcstride = 6 * prc->Width;
-            srcdatasize = srcstride * prc->Height;
-
-            srcdata = HeapAlloc(GetProcessHeap(), 0, srcdatasize);
-            if (!srcdata) return E_OUTOFMEMORY;
-
-            res = IWICBitmapSource_CopyPixels(This->source, prc, srcstride, srcdatasize, srcdata);
+    }
+    else
+    {
+        BYTE *srcdata;
+        UINT srcstride, rows, i;
+        WICRect rc;
 
-            if (SUCCEEDED(res))
-            {
-                srcrow = srcdata;
-                dstrow = pbBuffer;
-                for (y=0; y<prc->Height; y++) {
-                    srcpixel=srcrow;
-                    dstpixel=(DWORD*)dstrow;
-                    for (x=0; x<prc->Width; x++) {
-                        BYTE red, green, blue;
-                        red = *srcpixel++; srcpixel++;
-                        green = *srcpixel++; srcpixel++;
-                        blue = *srcpixel++; srcpixel++;
-                        *dstpixel++=0xff000000|red<<16|green<<8|blue;
-                    }
-                    srcrow += srcstride;
-                    dstrow += cbStride;
-                }
-            }
+        srcstride = (conversion->bpp * prc->Width + 7) / 8;
+        rows = min(max(CONVERT_STRIP_SIZE / srcstride, 1), prc->Height);
 
-            HeapFree(GetProcessHeap(), 0, srcdata);
+        srcdata = HeapAlloc(GetProcessHeap(), 0, srcstride * rows);
+        if (!srcdata) return E_OUTOFMEMORY;
 
-            return res;
-        }
-        return S_OK;
-    case format_64bppRGBA:
-        if (prc)
+        rc = *prc;
+        for (y=0; y<prc->Height; y+=rc.Height)
         {
-            HRESULT res;
-            UINT x, y;
-            BYTE *srcdata;
-            UINT srcstride, srcdatasize;
-            const BYTE *srcrow;
-            const BYTE *srcpixel;
-            BYTE *dstrow;
-            DWORD *dstpixel;
-
-            srcstride = 8 * prc->Width;
-            srcdatasize = srcstride * prc->Height;
-
-            srcdata = HeapAlloc(GetProcessHeap(), 0, srcdatasize);
-            if (!srcdata) return E_OUTOFMEMORY;
+            rc.Y = prc->Y + y;
+            rc.Height = min(rows, prc->Height - y);
 
-            res = IWICBitmapSource_CopyPixels(This->source, prc, srcstride, srcdatasize, srcdata);
+            res = IWICBitmapSource_CopyPixels(This->source, &rc, srcstride, srcstride * rc.Height, srcdata);
+            if (FAILED(res)) break;
 
-            if (SUCCEEDED(res))
-            {
-                srcrow = srcdata;
-                dstrow = pbBuffer;
-                for (y=0; y<prc->Height; y++) {
-                    srcpixel=srcrow;
-                    dstpixel=(DWORD*)dstrow;
-                    for (x=0; x<prc->Width; x++) {
-                        BYTE red, green, blue, alpha;
-                        red = *srcpixel++; srcpixel++;
-                        green = *srcpixel++; srcpixel++;
-                        blue = *srcpixel++; srcpixel++;
-                        alpha = *srcpixel++; srcpixel++;
-                        *dstpixel++=alpha<<24|red<<16|green<<8|blue;
-                    }
-                    srcrow += srcstride;
-                    dstrow += cbStride;
-                }
-            }
-
-            HeapFree(GetProcessHeap(), 0, srcdata);
-
-            return res;
+            for (i=0; i<rc.Height; i++)
+                conversion->convert_row(srcdata + srcstride * i, (DWORD*)(pbBuffer + cbStride * (y+i)),
+                    prc->Width, conversion->bpp, colors);
         }
-        return S_OK;
-    case format_32bppCMYK:
-        if (prc)
-        {
-            HRESULT res;
-            UINT x, y;
-
-            res = IWICBitmapSource_CopyPixels(This->source, prc, cbStride, cbBufferSize, pbBuffer);
-            if (FAILED(res)) return res;
 
-            for (y=0; y<prc->Height; y++)
-                for (x=0; x<prc->Width; x++)
-                {
-                    BYTE *pixel = pbBuffer+cbStride*y+4*x;
-                    BYTE c=pixel[0], m=pixel[1], y=pixel[2], k=pixel[3];
-                    pixel[0] = (255-y)*(255-k)/255; /* blue */
-                    pixel[1] = (255-m)*(255-k)/255; /* green */
-                    pixel[2] = (255-c)*(255-k)/255; /* red */
-                    pixel[3] = 255; /* alpha */
-                }
-        }
-        return S_OK;
-    default:
-        return WINCODEC_ERR_UNSUPPORTEDOPERATION;
+        HeapFree(GetProcessHeap(), 0, srcdata);
     }
+
+    return res;
 }
 
 static HRESULT copypixels_to_32bppBGR(struct FormatConverter *This, const WICRect *prc,
@@ -807,6 +431,74 @@ static HRESULT copypixels_to_32bppPBGRA(struct FormatConverter *This, const WICR
     }
 }
 
+static HRESULT copypixels_to_24bppBGR(struct FormatConverter *This, const WICRect *prc,
+    UINT cbStride, UINT cbBufferSize, BYTE *pbBuffer, enum pixelformat source_format)
+{
+    HRESULT res = S_OK;
+    BYTE *srcdata;
+    UINT srcstride, rows, x, y, i;
+    WICRect rc;
+
+    switch (source_format)
+    {
+    case format_24bppBGR:
+        if (prc)
+            return IWICBitmapSource_CopyPixels(This->source, prc, cbStride, cbBufferSize, pbBuffer);
+        return S_OK;
+    default:
+        if (!prc || prc->Width <= 0 || prc->Height <= 0)
+            return S_OK;
+
+        if (cbStride < 3 * prc->Width || cbStride * (prc->Height-1) + 3 * prc->Width > cbBufferSize)
+            return E_INVALIDARG;
+
+        /* convert a strip of rows at a time through 32bppBGRA */
+        srcstride = 4 * prc->Width;
+        rows = min(max(CONVERT_STRIP_SIZE / srcstride, 1), prc->Height);
+
+        srcdata = HeapAlloc(GetProcessHeap(), 0, srcstride * rows);
+        if (!srcdata) return E_OUTOFMEMORY;
+
+        rc = *prc;
+        for (y=0; y<prc->Height; y+=rc.Height)
+        {
+            rc.Y = prc->Y + y;
+            rc.Height = min(rows, prc->Height - y);
+
+            switch (source_format)
+            {
+            case format_32bppBGR:
+            case format_32bppBGRA:
+            case format_32bppPBGRA:
+                res = IWICBitmapSource_CopyPixels(This->source, &rc, srcstride, srcstride * rc.Height, srcdata);
+                break;
+            default:
+                res = copypixels_to_32bppBGRA(This, &rc, srcstride, srcstride * rc.Height, srcdata, source_format);
+                break;
+            }
+            if (FAILED(res)) break;
+
+            for (i=0; i<rc.Height; i++)
+            {
+                const BYTE *srcpixel = srcdata + srcstride * i;
+                BYTE *dstpixel = pbBuffer + cbStride * (y+i);
+
+                for (x=0; x<prc->Width; x++)
+                {
+                    *dstpixel++ = *srcpixel++; /* blue */
+                    *dstpixel++ = *srcpixel++; /* green */
+                    *dstpixel++ = *srcpixel++; /* red */
+                    srcpixel++; /* alpha */
+                }
+            }
+        }
+
+        HeapFree(GetProcessHeap(), 0, srcdata);
+
+        return res;
+    }
+}
+
 static const struct pixelformatinfo supported_formats[] = {
     {format_1bppIndexed, &GUID_WICPixelFormat1bppIndexed, NULL},
     {format_2bppIndexed, &GUID_WICPixelFormat2bppIndexed, NULL},
@@ -820,7 +512,7 @@ static const struct pixelformatinfo supported_formats[] = {
     {format_16bppBGR555, &GUID_WICPixelFormat16bppBGR555, NULL},
     {format_16bppBGR565, &GUID_WICPixelFormat16bppBGR565, NULL},
     {format_16bppBGRA5551, &GUID_WICPixelFormat16bppBGRA5551, NULL},
-    {format_24bppBGR, &GUID_WICPixelFormat24bppBGR, NULL},
+    {format_24bppBGR, &GUID_WICPixelFormat24bppBGR, copypixels_to_24bppBGR},
     {format_32bppBGR, &GUID_WICPixelFormat32bppBGR, copypixels_to_32bppBGR},
     {format_32bppBGRA, &GUID_WICPixelFormat32bppBGRA, copypixels_to_32bppBGRA},
     {format_32bppPBGRA, &GUID_WICPixelFormat32bppPBGRA, copypixels_to_32bppPBGRA},
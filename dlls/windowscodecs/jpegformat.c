@@ -62,6 +62,7 @@ WINE_DECLARE_DEBUG_CHANNEL(jpeg);
 static void *libjpeg_handle;
 
 #define MAKE_FUNCPTR(f) static typeof(f) * p##f
+MAKE_FUNCPTR(jpeg_abort_decompress);
 MAKE_FUNCPTR(jpeg_CreateCompress);
 MAKE_FUNCPTR(jpeg_CreateDecompress);
 MAKE_FUNCPTR(jpeg_destroy_compress);
@@ -87,6 +88,7 @@ static void *load_libjpeg(void)
         return NULL; \
     }
 
+        LOAD_FUNCPTR(jpeg_abort_decompress);
         LOAD_FUNCPTR(jpeg_CreateCompress);
         LOAD_FUNCPTR(jpeg_CreateDecompress);
         LOAD_FUNCPTR(jpeg_destroy_compress);
@@ -140,6 +142,7 @@ static void emit_message_fn(j_common_ptr cinfo, int msg_level)
 typedef struct {
     IWICBitmapDecoder IWICBitmapDecoder_iface;
     IWICBitmapFrameDecode IWICBitmapFrameDecode_iface;
+    IWICBitmapSourceTransform IWICBitmapSourceTransform_iface;
     LONG ref;
     BOOL initialized;
     BOOL cinfo_initialized;
@@ -162,6 +165,11 @@ static inline JpegDecoder *impl_from_IWICBitmapFrameDecode(IWICBitmapFrameDecode
     return CONTAINING_RECORD(iface, JpegDecoder, IWICBitmapFrameDecode_iface);
 }
 
+static inline JpegDecoder *impl_from_IWICBitmapSourceTransform(IWICBitmapSourceTransform *iface)
+{
+    return CONTAINING_RECORD(iface, JpegDecoder, IWICBitmapSourceTransform_iface);
+}
+
 static inline JpegDecoder *decoder_from_decompress(j_decompress_ptr decompress)
 {
     return CONTAINING_RECORD(decompress, JpegDecoder, cinfo);
@@ -495,6 +503,10 @@ static HRESULT WINAPI JpegDecoder_Frame_QueryInterface(IWICBitmapFrameDecode *if
     {
         *ppv = &This->IWICBitmapFrameDecode_iface;
     }
+    else if (IsEqualIID(&IID_IWICBitmapSourceTransform, iid))
+    {
+        *ppv = &This->IWICBitmapSourceTransform_iface;
+    }
     else
     {
         *ppv = NULL;
@@ -521,8 +533,8 @@ static HRESULT WINAPI JpegDecoder_Frame_GetSize(IWICBitmapFrameDecode *iface,
     UINT *puiWidth, UINT *puiHeight)
 {
     JpegDecoder *This = impl_from_IWICBitmapFrameDecode(iface);
-    *puiWidth = This->cinfo.output_width;
-    *puiHeight = This->cinfo.output_height;
+    *puiWidth = This->cinfo.image_width;
+    *puiHeight = This->cinfo.image_height;
     TRACE("(%p)->(%u,%u)\n", iface, *puiWidth, *puiHeight);
     return S_OK;
 }
@@ -574,61 +586,73 @@ static HRESULT WINAPI JpegDecoder_Frame_CopyPalette(IWICBitmapFrameDecode *iface
     return E_NOTIMPL;
 }
 
-static HRESULT WINAPI JpegDecoder_Frame_CopyPixels(IWICBitmapFrameDecode *iface,
-    const WICRect *prc, UINT cbStride, UINT cbBufferSize, BYTE *pbBuffer)
+static UINT JpegDecoder_GetBpp(JpegDecoder *This)
+{
+    if (This->cinfo.out_color_space == JCS_GRAYSCALE) return 8;
+    else if (This->cinfo.out_color_space == JCS_CMYK) return 32;
+    else return 24;
+}
+
+/* Decodes the image at 1/scale_denom of its full size into image_data, up to
+ * row max_row_needed of the scaled image. If decompression was started at
+ * another scale, it is restarted from the beginning of the stream. Must be
+ * called with the lock held. */
+static HRESULT JpegDecoder_DecodeRows(JpegDecoder *This, UINT scale_denom, UINT max_row_needed)
 {
-    JpegDecoder *This = impl_from_IWICBitmapFrameDecode(iface);
     UINT bpp;
     UINT stride;
     UINT data_size;
-    UINT max_row_needed;
     jmp_buf jmpbuf;
-    WICRect rect;
-    TRACE("(%p,%p,%u,%u,%p)\n", iface, prc, cbStride, cbBufferSize, pbBuffer);
 
-    if (!prc)
-    {
-        rect.X = 0;
-        rect.Y = 0;
-        rect.Width = This->cinfo.output_width;
-        rect.Height = This->cinfo.output_height;
-        prc = &rect;
-    }
-    else
+    This->cinfo.client_data = jmpbuf;
+
+    if (setjmp(jmpbuf))
+        return E_FAIL;
+
+    if (This->cinfo.scale_denom != scale_denom)
     {
-        if (prc->X < 0 || prc->Y < 0 || prc->X+prc->Width > This->cinfo.output_width ||
-            prc->Y+prc->Height > This->cinfo.output_height)
-            return E_INVALIDARG;
-    }
+        J_COLOR_SPACE out_color_space = This->cinfo.out_color_space;
+        LARGE_INTEGER seek;
+        int ret;
 
-    if (This->cinfo.out_color_space == JCS_GRAYSCALE) bpp = 8;
-    else if (This->cinfo.out_color_space == JCS_CMYK) bpp = 32;
-    else bpp = 24;
+        TRACE("restarting decompression at scale 1/%u\n", scale_denom);
 
-    stride = bpp * This->cinfo.output_width;
-    data_size = stride * This->cinfo.output_height;
+        pjpeg_abort_decompress(&This->cinfo);
+        HeapFree(GetProcessHeap(), 0, This->image_data);
+        This->image_data = NULL;
+
+        seek.QuadPart = 0;
+        IStream_Seek(This->stream, seek, STREAM_SEEK_SET, NULL);
+        This->source_mgr.bytes_in_buffer = 0;
 
-    max_row_needed = prc->Y + prc->Height;
-    if (max_row_needed > This->cinfo.output_height) return E_INVALIDARG;
+        ret = pjpeg_read_header(&This->cinfo, TRUE);
+        if (ret != JPEG_HEADER_OK)
+        {
+            WARN("read header returned %d.\n", ret);
+            return E_FAIL;
+        }
 
-    EnterCriticalSection(&This->lock);
+        /* jpeg_read_header resets the decompression parameters */
+        This->cinfo.out_color_space = out_color_space;
+        This->cinfo.scale_num = 1;
+        This->cinfo.scale_denom = scale_denom;
 
-    if (!This->image_data)
-    {
-        This->image_data = HeapAlloc(GetProcessHeap(), 0, data_size);
-        if (!This->image_data)
+        if (!pjpeg_start_decompress(&This->cinfo))
         {
-            LeaveCriticalSection(&This->lock);
-            return E_OUTOFMEMORY;
+            ERR("jpeg_start_decompress failed\n");
+            return E_FAIL;
         }
     }
 
-    This->cinfo.client_data = jmpbuf;
+    bpp = JpegDecoder_GetBpp(This);
+    stride = (bpp * This->cinfo.output_width + 7) / 8;
+    data_size = stride * This->cinfo.output_height;
 
-    if (setjmp(jmpbuf))
+    if (!This->image_data)
     {
-        LeaveCriticalSection(&This->lock);
-        return E_FAIL;
+        This->image_data = HeapAlloc(GetProcessHeap(), 0, data_size);
+        if (!This->image_data)
+            return E_OUTOFMEMORY;
     }
 
     while (max_row_needed > This->cinfo.output_scanline)
@@ -648,7 +672,6 @@ static HRESULT WINAPI JpegDecoder_Frame_CopyPixels(IWICBitmapFrameDecode *iface,
         if (ret == 0)
         {
             ERR("read_scanlines failed\n");
-            LeaveCriticalSection(&This->lock);
             return E_FAIL;
         }
 
@@ -662,15 +685,57 @@ static HRESULT WINAPI JpegDecoder_Frame_CopyPixels(IWICBitmapFrameDecode *iface,
 
         if (This->cinfo.out_color_space == JCS_CMYK && This->cinfo.saw_Adobe_marker)
             /* Adobe JPEG's have inverted CMYK data. */
-            for (i=0; i<data_size; i++)
+            for (i=stride * first_scanline; i<stride * This->cinfo.output_scanline; i++)
                 This->image_data[i] ^= 0xff;
     }
 
+    return S_OK;
+}
+
+static HRESULT JpegDecoder_CopyScaledPixels(JpegDecoder *This, UINT scale_denom,
+    const WICRect *prc, UINT cbStride, UINT cbBufferSize, BYTE *pbBuffer)
+{
+    UINT bpp = JpegDecoder_GetBpp(This);
+    HRESULT hr;
+
+    EnterCriticalSection(&This->lock);
+
+    hr = JpegDecoder_DecodeRows(This, scale_denom, prc->Y + prc->Height);
+
+    if (SUCCEEDED(hr))
+        hr = copy_pixels(bpp, This->image_data,
+            This->cinfo.output_width, This->cinfo.output_height,
+            (bpp * This->cinfo.output_width + 7) / 8,
+            prc, cbStride, cbBufferSize, pbBuffer);
+
     LeaveCriticalSection(&This->lock);
 
-    return copy_pixels(bpp, This->image_data,
-        This->cinfo.output_width, This->cinfo.output_height, stride,
-        prc, cbStride, cbBufferSize, pbBuffer);
+    return hr;
+}
+
+static HRESULT WINAPI JpegDecoder_Frame_CopyPixels(IWICBitmapFrameDecode *iface,
+    const WICRect *prc, UINT cbStride, UINT cbBufferSize, BYTE *pbBuffer)
+{
+    JpegDecoder *This = impl_from_IWICBitmapFrameDecode(iface);
+    WICRect rect;
+    TRACE("(%p,%p,%u,%u,%p)\n", iface, prc, cbStride, cbBufferSize, pbBuffer);
+
+    if (!prc)
+    {
+        rect.X = 0;
+        rect.Y = 0;
+        rect.Width = This->cinfo.image_width;
+        rect.Height = This->cinfo.image_height;
+        prc = &rect;
+    }
+    else
+    {
+        if (prc->X < 0 || prc->Y < 0 || prc->X+prc->Width > This->cinfo.image_width ||
+            prc->Y+prc->Height > This->cinfo.image_height)
+            return E_INVALIDARG;
+    }
+
+    return JpegDecoder_CopyScaledPixels(This, 1, prc, cbStride, cbBufferSize, pbBuffer);
 }
 
 static HRESULT WINAPI JpegDecoder_Frame_GetMetadataQueryReader(IWICBitmapFrameDecode *iface,
@@ -708,6 +773,149 @@ static const IWICBitmapFrameDecodeVtbl JpegDecoder_Frame_Vtbl = {
     JpegDecoder_Frame_GetThumbnail
 };
 
+static HRESULT WINAPI JpegDecoder_Transform_QueryInterface(IWICBitmapSourceTransform *iface,
+    REFIID iid, void **ppv)
+{
+    JpegDecoder *This = impl_from_IWICBitmapSourceTransform(iface);
+    return IWICBitmapFrameDecode_QueryInterface(&This->IWICBitmapFrameDecode_iface, iid, ppv);
+}
+
+static ULONG WINAPI JpegDecoder_Transform_AddRef(IWICBitmapSourceTransform *iface)
+{
+    JpegDecoder *This = impl_from_IWICBitmapSourceTransform(iface);
+    return IWICBitmapDecoder_AddRef(&This->IWICBitmapDecoder_iface);
+}
+
+static ULONG WINAPI JpegDecoder_Transform_Release(IWICBitmapSourceTransform *iface)
+{
+    JpegDecoder *This = impl_from_IWICBitmapSourceTransform(iface);
+    return IWICBitmapDecoder_Release(&This->IWICBitmapDecoder_iface);
+}
+
+static inline UINT get_scaled_size(UINT size, UINT scale_denom)
+{
+    return (size + scale_denom - 1) / scale_denom;
+}
+
+/* libjpeg can scale by 1/2, 1/4 and 1/8 while decoding, at a fraction of the
+ * cost of a full decode. Returns the smallest of these scales that still
+ * gives an image of at least width x height pixels. */
+static UINT JpegDecoder_GetScaleDenom(JpegDecoder *This, UINT width, UINT height)
+{
+    UINT scale_denom;
+
+    for (scale_denom = 8; scale_denom > 1; scale_denom /= 2)
+    {
+        if (get_scaled_size(This->cinfo.image_width, scale_denom) >= width &&
+            get_scaled_size(This->cinfo.image_height, scale_denom) >= height)
+            break;
+    }
+
+    return scale_denom;
+}
+
+static HRESULT WINAPI JpegDecoder_Transform_CopyPixels(IWICBitmapSourceTransform *iface,
+    const WICRect *prc, UINT uiWidth, UINT uiHeight, WICPixelFormatGUID *pguidDstFormat,
+    WICBitmapTransformOptions dstTransform, UINT nStride, UINT cbBufferSize, BYTE *pbBuffer)
+{
+    JpegDecoder *This = impl_from_IWICBitmapSourceTransform(iface);
+    WICPixelFormatGUID format;
+    UINT scale_denom;
+    WICRect rect;
+
+    TRACE("(%p,%p,%u,%u,%s,%u,%u,%u,%p)\n", iface, prc, uiWidth, uiHeight,
+        debugstr_guid(pguidDstFormat), dstTransform, nStride, cbBufferSize, pbBuffer);
+
+    if (dstTransform != WICBitmapTransformRotate0)
+    {
+        FIXME("unsupported transform %u\n", dstTransform);
+        return WINCODEC_ERR_UNSUPPORTEDOPERATION;
+    }
+
+    if (pguidDstFormat)
+    {
+        JpegDecoder_Frame_GetPixelFormat(&This->IWICBitmapFrameDecode_iface, &format);
+        if (!IsEqualGUID(pguidDstFormat, &format))
+        {
+            FIXME("unsupported format %s\n", debugstr_guid(pguidDstFormat));
+            return WINCODEC_ERR_UNSUPPORTEDPIXELFORMAT;
+        }
+    }
+
+    scale_denom = JpegDecoder_GetScaleDenom(This, uiWidth, uiHeight);
+    if (get_scaled_size(This->cinfo.image_width, scale_denom) != uiWidth ||
+        get_scaled_size(This->cinfo.image_height, scale_denom) != uiHeight)
+        return E_INVALIDARG;
+
+    if (!prc)
+    {
+        rect.X = 0;
+        rect.Y = 0;
+        rect.Width = uiWidth;
+        rect.Height = uiHeight;
+        prc = &rect;
+    }
+    else
+    {
+        if (prc->X < 0 || prc->Y < 0 || prc->X+prc->Width > uiWidth ||
+            prc->Y+prc->Height > uiHeight)
+            return E_INVALIDARG;
+    }
+
+    return JpegDecoder_CopyScaledPixels(This, scale_denom, prc, nStride, cbBufferSize, pbBuffer);
+}
+
+static HRESULT WINAPI JpegDecoder_Transform_GetClosestSize(IWICBitmapSourceTransform *iface,
+    UINT *puiWidth, UINT *puiHeight)
+{
+    JpegDecoder *This = impl_from_IWICBitmapSourceTransform(iface);
+    UINT scale_denom;
+
+    TRACE("(%p,%p,%p)\n", iface, puiWidth, puiHeight);
+
+    if (!puiWidth || !puiHeight) return E_INVALIDARG;
+
+    scale_denom = JpegDecoder_GetScaleDenom(This, *puiWidth, *puiHeight);
+    *puiWidth = get_scaled_size(This->cinfo.image_width, scale_denom);
+    *puiHeight = get_scaled_size(This->cinfo.image_height, scale_denom);
+
+    return S_OK;
+}
+
+static HRESULT WINAPI JpegDecoder_Transform_GetClosestPixelFormat(IWICBitmapSourceTransform *iface,
+    WICPixelFormatGUID *pguidDstFormat)
+{
+    JpegDecoder *This = impl_from_IWICBitmapSourceTransform(iface);
+
+    TRACE("(%p,%p)\n", iface, pguidDstFormat);
+
+    if (!pguidDstFormat) return E_INVALIDARG;
+
+    return JpegDecoder_Frame_GetPixelFormat(&This->IWICBitmapFrameDecode_iface, pguidDstFormat);
+}
+
+static HRESULT WINAPI JpegDecoder_Transform_DoesSupportTransform(IWICBitmapSourceTransform *iface,
+    WICBitmapTransformOptions dstTransform, BOOL *pfIsSupported)
+{
+    TRACE("(%p,%u,%p)\n", iface, dstTransform, pfIsSupported);
+
+    if (!pfIsSupported) return E_INVALIDARG;
+
+    *pfIsSupported = (dstTransform == WICBitmapTransformRotate0);
+
+    return S_OK;
+}
+
+static const IWICBitmapSourceTransformVtbl JpegDecoder_Transform_Vtbl = {
+    JpegDecoder_Transform_QueryInterface,
+    JpegDecoder_Transform_AddRef,
+    JpegDecoder_Transform_Release,
+    JpegDecoder_Transform_CopyPixels,
+    JpegDecoder_Transform_GetClosestSize,
+    JpegDecoder_Transform_GetClosestPixelFormat,
+    JpegDecoder_Transform_DoesSupportTransform
+};
+
 HRESULT JpegDecoder_CreateInstance(IUnknown *pUnkOuter, REFIID iid, void** ppv)
 {
     JpegDecoder *This;
@@ -730,6 +938,7 @@ HRESULT JpegDecoder_CreateInstance(IUnknown *pUnkOuter, REFIID iid, void** ppv)
 
     This->IWICBitmapDecoder_iface.lpVtbl = &JpegDecoder_Vtbl;
     This->IWICBitmapFrameDecode_iface.lpVtbl = &JpegDecoder_Frame_Vtbl;
+    This->IWICBitmapSourceTransform_iface.lpVtbl = &JpegDecoder_Transform_Vtbl;
     This->ref = 1;
     This->initialized = FALSE;
     This->cinfo_initialized = FALSE;
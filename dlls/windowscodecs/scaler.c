@@ -37,6 +37,8 @@ typedef struct BitmapScaler {
     IWICBitmapScaler IWICBitmapScaler_iface;
     LONG ref;
     IWICBitmapSource *source;
+    IWICBitmapSourceTransform *transform;
+    WICPixelFormatGUID src_format;
     UINT width, height;
     UINT src_width, src_height;
     WICBitmapInterpolationMode mode;
@@ -97,6 +99,7 @@ static ULONG WINAPI BitmapScaler_Release(IWICBitmapScaler *iface)
         This->lock.DebugInfo->Spare[0] = 0;
         DeleteCriticalSection(&This->lock);
         if (This->source) IWICBitmapSource_Release(This->source);
+        if (This->transform) IWICBitmapSourceTransform_Release(This->transform);
         HeapFree(GetProcessHeap(), 0, This);
     }
 
@@ -191,6 +194,158 @@ static void NearestNeighbor_CopyScanline(BitmapScaler *This,
     }
 }
 
+#define FILTER_MAX_TAPS 4
+
+/* Returns the source pixels contributing to destination pixel dst along one
+ * axis, and their weights in 1/256ths. Linear filtering uses two taps, cubic
+ * filtering uses four taps of a Catmull-Rom spline. */
+static UINT Filter_GetTaps(BitmapScaler *This, UINT dst, UINT dst_size, UINT src_size,
+    UINT *taps, INT *weights)
+{
+    INT pos, frac, frac2, frac3, i;
+    UINT count;
+
+    /* Map the center of the destination pixel onto the source, in 1/256ths of a pixel. */
+    pos = (INT)((2 * (ULONGLONG)dst + 1) * src_size * 128 / dst_size) - 128;
+    if (pos < 0) pos = 0;
+    frac = pos & 0xff;
+    pos >>= 8;
+
+    if (This->mode == WICBitmapInterpolationModeCubic)
+    {
+        frac2 = frac * frac >> 8;
+        frac3 = frac2 * frac >> 8;
+        weights[0] = (-frac + 2 * frac2 - frac3) / 2;
+        weights[2] = (frac + 4 * frac2 - 3 * frac3) / 2;
+        weights[3] = (frac3 - frac2) / 2;
+        weights[1] = 256 - weights[0] - weights[2] - weights[3];
+        pos--;
+        count = 4;
+    }
+    else
+    {
+        weights[0] = 256 - frac;
+        weights[1] = frac;
+        count = 2;
+    }
+
+    for (i=0; i<count; i++)
+        taps[i] = min(max(pos + i, 0), (INT)src_size - 1);
+
+    return count;
+}
+
+static void Filter_GetRequiredSourceRect(BitmapScaler *This,
+    UINT x, UINT y, WICRect *src_rect)
+{
+    UINT taps[FILTER_MAX_TAPS], count;
+    INT weights[FILTER_MAX_TAPS];
+
+    count = Filter_GetTaps(This, x, This->width, This->src_width, taps, weights);
+    src_rect->X = taps[0];
+    src_rect->Width = taps[count-1] - taps[0] + 1;
+
+    count = Filter_GetTaps(This, y, This->height, This->src_height, taps, weights);
+    src_rect->Y = taps[0];
+    src_rect->Height = taps[count-1] - taps[0] + 1;
+}
+
+static void Filter_CopyScanline(BitmapScaler *This,
+    UINT dst_x, UINT dst_y, UINT dst_width,
+    BYTE **src_data, UINT src_data_x, UINT src_data_y, BYTE *pbBuffer)
+{
+    UINT bytesperpixel = This->bpp/8;
+    UINT taps_x[FILTER_MAX_TAPS], taps_y[FILTER_MAX_TAPS], count_x, count_y;
+    INT weights_x[FILTER_MAX_TAPS], weights_y[FILTER_MAX_TAPS];
+    const BYTE *rows[FILTER_MAX_TAPS];
+    UINT i, j, k, c;
+    INT value, sum;
+
+    count_y = Filter_GetTaps(This, dst_y, This->height, This->src_height, taps_y, weights_y);
+    for (j=0; j<count_y; j++)
+        rows[j] = src_data[taps_y[j] - src_data_y];
+
+    for (i=0; i<dst_width; i++)
+    {
+        count_x = Filter_GetTaps(This, dst_x + i, This->width, This->src_width, taps_x, weights_x);
+        for (k=0; k<count_x; k++)
+            taps_x[k] = (taps_x[k] - src_data_x) * bytesperpixel;
+
+        for (c=0; c<bytesperpixel; c++)
+        {
+            value = 0;
+            for (j=0; j<count_y; j++)
+            {
+                sum = 0;
+                for (k=0; k<count_x; k++)
+                    sum += rows[j][taps_x[k] + c] * weights_x[k];
+                value += sum * weights_y[j];
+            }
+
+            if (value <= 0)
+                pbBuffer[c] = 0;
+            else
+                pbBuffer[c] = min((value + 0x8000) >> 16, 0xff);
+        }
+        pbBuffer += bytesperpixel;
+    }
+}
+
+/* Returns the span of source pixels covered by destination pixel dst along
+ * one axis. Only used when shrinking, so spans are never empty. */
+static void Fant_GetSpan(UINT dst, UINT dst_size, UINT src_size, UINT *first, UINT *count)
+{
+    *first = (UINT)((ULONGLONG)dst * src_size / dst_size);
+    *count = (UINT)(((dst + 1) * (ULONGLONG)src_size + dst_size - 1) / dst_size) - *first;
+}
+
+static void Fant_GetRequiredSourceRect(BitmapScaler *This,
+    UINT x, UINT y, WICRect *src_rect)
+{
+    UINT first, count;
+
+    Fant_GetSpan(x, This->width, This->src_width, &first, &count);
+    src_rect->X = first;
+    src_rect->Width = count;
+
+    Fant_GetSpan(y, This->height, This->src_height, &first, &count);
+    src_rect->Y = first;
+    src_rect->Height = count;
+}
+
+static void Fant_CopyScanline(BitmapScaler *This,
+    UINT dst_x, UINT dst_y, UINT dst_width,
+    BYTE **src_data, UINT src_data_x, UINT src_data_y, BYTE *pbBuffer)
+{
+    UINT bytesperpixel = This->bpp/8;
+    UINT first_x, count_x, first_y, count_y, area;
+    UINT i, j, k, c, sum;
+    const BYTE *src;
+
+    Fant_GetSpan(dst_y, This->height, This->src_height, &first_y, &count_y);
+    first_y -= src_data_y;
+
+    for (i=0; i<dst_width; i++)
+    {
+        Fant_GetSpan(dst_x + i, This->width, This->src_width, &first_x, &count_x);
+        first_x -= src_data_x;
+        area = count_x * count_y;
+
+        for (c=0; c<bytesperpixel; c++)
+        {
+            sum = 0;
+            for (j=0; j<count_y; j++)
+            {
+                src = src_data[first_y + j] + first_x * bytesperpixel + c;
+                for (k=0; k<count_x; k++)
+                    sum += src[k * bytesperpixel];
+            }
+            pbBuffer[c] = (sum + area / 2) / area;
+        }
+        pbBuffer += bytesperpixel;
+    }
+}
+
 static HRESULT WINAPI BitmapScaler_CopyPixels(IWICBitmapScaler *iface,
     const WICRect *prc, UINT cbStride, UINT cbBufferSize, BYTE *pbBuffer)
 {
@@ -279,8 +434,13 @@ static HRESULT WINAPI BitmapScaler_CopyPixels(IWICBitmapScaler *iface,
     for (y=0; y<src_rect.Height; y++)
         src_rows[y] = src_bits + y * src_bytesperrow;
 
-    hr = IWICBitmapSource_CopyPixels(This->source, &src_rect, src_bytesperrow,
-        buffer_size, src_bits);
+    if (This->transform)
+        hr = IWICBitmapSourceTransform_CopyPixels(This->transform, &src_rect,
+            This->src_width, This->src_height, &This->src_format, WICBitmapTransformRotate0,
+            src_bytesperrow, buffer_size, src_bits);
+    else
+        hr = IWICBitmapSource_CopyPixels(This->source, &src_rect, src_bytesperrow,
+            buffer_size, src_bits);
 
     if (SUCCEEDED(hr))
     {
@@ -300,6 +460,50 @@ end:
     return hr;
 }
 
+/* Formats with 8 bits per channel, which can be filtered one byte at a time. */
+static BOOL is_8bpc_format(const WICPixelFormatGUID *format)
+{
+    return IsEqualGUID(format, &GUID_WICPixelFormat8bppGray) ||
+           IsEqualGUID(format, &GUID_WICPixelFormat24bppBGR) ||
+           IsEqualGUID(format, &GUID_WICPixelFormat32bppBGR) ||
+           IsEqualGUID(format, &GUID_WICPixelFormat32bppBGRA) ||
+           IsEqualGUID(format, &GUID_WICPixelFormat32bppPBGRA) ||
+           IsEqualGUID(format, &GUID_WICPixelFormat32bppCMYK);
+}
+
+/* Lets sources such as JPEG frames decode at a reduced size, as long as it is
+ * still at least as large as the requested one, so that the filter only has
+ * to do the remaining part of the scaling. */
+static void BitmapScaler_InitSourceTransform(BitmapScaler *This)
+{
+    IWICBitmapSourceTransform *transform;
+    WICPixelFormatGUID format = This->src_format;
+    UINT width = This->width, height = This->height;
+    BOOL supported = FALSE;
+
+    if (FAILED(IWICBitmapSource_QueryInterface(This->source, &IID_IWICBitmapSourceTransform,
+            (void**)&transform)))
+        return;
+
+    if (SUCCEEDED(IWICBitmapSourceTransform_DoesSupportTransform(transform,
+            WICBitmapTransformRotate0, &supported)) && supported &&
+        SUCCEEDED(IWICBitmapSourceTransform_GetClosestPixelFormat(transform, &format)) &&
+        IsEqualGUID(&format, &This->src_format) &&
+        SUCCEEDED(IWICBitmapSourceTransform_GetClosestSize(transform, &width, &height)) &&
+        width >= This->width && height >= This->height &&
+        (width < This->src_width || height < This->src_height))
+    {
+        TRACE("using %ux%u source transform for %ux%u image\n", width, height,
+            This->src_width, This->src_height);
+        This->transform = transform;
+        This->src_width = width;
+        This->src_height = height;
+        return;
+    }
+
+    IWICBitmapSourceTransform_Release(transform);
+}
+
 static HRESULT WINAPI BitmapScaler_Initialize(IWICBitmapScaler *iface,
     IWICBitmapSource *pISource, UINT uiWidth, UINT uiHeight,
     WICBitmapInterpolationMode mode)
@@ -334,23 +538,54 @@ static HRESULT WINAPI BitmapScaler_Initialize(IWICBitmapScaler *iface,
 
     if (SUCCEEDED(hr))
     {
+        if ((This->bpp % 8) == 0)
+        {
+            IWICBitmapSource_AddRef(pISource);
+            This->source = pISource;
+        }
+        else
+        {
+            hr = WICConvertBitmapSource(&GUID_WICPixelFormat32bppBGRA,
+                pISource, &This->source);
+            src_pixelformat = GUID_WICPixelFormat32bppBGRA;
+            This->bpp = 32;
+        }
+    }
+
+    if (SUCCEEDED(hr))
+    {
+        This->src_format = src_pixelformat;
+
+        if (mode != WICBitmapInterpolationModeNearestNeighbor && !is_8bpc_format(&src_pixelformat))
+        {
+            FIXME("filtering %s is not supported, using nearest neighbor\n",
+                debugstr_guid(&src_pixelformat));
+            mode = WICBitmapInterpolationModeNearestNeighbor;
+        }
+
+        if (mode != WICBitmapInterpolationModeNearestNeighbor && This->source == pISource)
+            BitmapScaler_InitSourceTransform(This);
+
         switch (mode)
         {
+        case WICBitmapInterpolationModeFant:
+            if (This->width <= This->src_width && This->height <= This->src_height)
+            {
+                This->fn_get_required_source_rect = Fant_GetRequiredSourceRect;
+                This->fn_copy_scanline = Fant_CopyScanline;
+                break;
+            }
+            /* Fant only differs from linear filtering when shrinking */
+            /* fall-through */
+        case WICBitmapInterpolationModeLinear:
+        case WICBitmapInterpolationModeCubic:
+            This->fn_get_required_source_rect = Filter_GetRequiredSourceRect;
+            This->fn_copy_scanline = Filter_CopyScanline;
+            break;
         default:
             FIXME("unsupported mode %i\n", mode);
             /* fall-through */
         case WICBitmapInterpolationModeNearestNeighbor:
-            if ((This->bpp % 8) == 0)
-            {
-                IWICBitmapSource_AddRef(pISource);
-                This->source = pISource;
-            }
-            else
-            {
-                hr = WICConvertBitmapSource(&GUID_WICPixelFormat32bppBGRA,
-                    pISource, &This->source);
-                This->bpp = 32;
-            }
             This->fn_get_required_source_rect = NearestNeighbor_GetRequiredSourceRect;
             This->fn_copy_scanline = NearestNeighbor_CopyScanline;
             break;
@@ -385,6 +620,7 @@ HRESULT BitmapScaler_Create(IWICBitmapScaler **scaler)
     This->IWICBitmapScaler_iface.lpVtbl = &BitmapScaler_Vtbl;
     This->ref = 1;
     This->source = NULL;
+    This->transform = NULL;
     This->width = 0;
     This->height = 0;
     This->src_width = 0;
@@ -418,6 +418,79 @@ static void test_createbitmapfromsource(void)
     IWICBitmap_Release(bitmap2);
 }
 
+static void test_bitmapscaler(void)
+{
+    static const BYTE bitmap_data[16] = {
+        10,  30, 100, 100,
+        50,  70, 100, 100,
+         0,   0, 200, 220,
+         0,   0, 240,   4};
+    static const BYTE expected_data[4] = {40, 100, 0, 166};
+    static const WICBitmapInterpolationMode modes[] = {
+        WICBitmapInterpolationModeLinear, WICBitmapInterpolationModeFant};
+    HRESULT hr;
+    IWICBitmap *bitmap;
+    IWICBitmapLock *lock;
+    IWICBitmapScaler *scaler;
+    BYTE *lock_buffer;
+    UINT lock_buffer_size, lock_buffer_stride;
+    BYTE returned_data[4];
+    UINT width, height;
+    int i, j;
+
+    hr = IWICImagingFactory_CreateBitmap(factory, 4, 4, &GUID_WICPixelFormat8bppGray,
+        WICBitmapCacheOnLoad, &bitmap);
+    ok(hr == S_OK, "IWICImagingFactory_CreateBitmap failed hr=%x\n", hr);
+    if (FAILED(hr))
+        return;
+
+    hr = IWICBitmap_Lock(bitmap, NULL, WICBitmapLockWrite, &lock);
+    ok(hr == S_OK, "IWICBitmap_Lock failed hr=%x\n", hr);
+    if (FAILED(hr))
+    {
+        IWICBitmap_Release(bitmap);
+        return;
+    }
+
+    hr = IWICBitmapLock_GetStride(lock, &lock_buffer_stride);
+    ok(hr == S_OK, "IWICBitmapLock_GetStride failed hr=%x\n", hr);
+
+    hr = IWICBitmapLock_GetDataPointer(lock, &lock_buffer_size, &lock_buffer);
+    ok(hr == S_OK, "IWICBitmapLock_GetDataPointer failed hr=%x\n", hr);
+
+    for (i=0; i<4; i++)
+        memcpy(lock_buffer + lock_buffer_stride*i, bitmap_data + i*4, 4);
+
+    IWICBitmapLock_Release(lock);
+
+    for (i=0; i<sizeof(modes)/sizeof(modes[0]); i++)
+    {
+        hr = IWICImagingFactory_CreateBitmapScaler(factory, &scaler);
+        ok(hr == S_OK, "IWICImagingFactory_CreateBitmapScaler failed hr=%x\n", hr);
+        if (FAILED(hr))
+            break;
+
+        hr = IWICBitmapScaler_Initialize(scaler, (IWICBitmapSource*)bitmap, 2, 2, modes[i]);
+        ok(hr == S_OK, "IWICBitmapScaler_Initialize failed hr=%x\n", hr);
+
+        hr = IWICBitmapScaler_GetSize(scaler, &width, &height);
+        ok(hr == S_OK, "IWICBitmapScaler_GetSize failed hr=%x\n", hr);
+        ok(width == 2 && height == 2, "mode %d: got %ux%u\n", modes[i], width, height);
+
+        memset(returned_data, 0xcc, sizeof(returned_data));
+        hr = IWICBitmapScaler_CopyPixels(scaler, NULL, 2, sizeof(returned_data), returned_data);
+        ok(hr == S_OK, "IWICBitmapScaler_CopyPixels failed hr=%x\n", hr);
+
+        for (j=0; j<4; j++)
+            ok(returned_data[j] == expected_data[j], "mode %d: returned_data[%i] == %i, expected %i\n",
+                modes[i], j, returned_data[j], expected_data[j]);
+
+        IWICBitmapScaler_Release(scaler);
+    }
+
+    IWICBitmap_Release(bitmap);
+}
+
 START_TEST(bitmap)
 {
     HRESULT hr;
@@ -430,6 +503,7 @@ START_TEST(bitmap)
 
     test_createbitmap();
     test_createbitmapfromsource();
+    test_bitmapscaler();
 
     IWICImagingFactory_Release(factory);
 
@@ -499,6 +499,9 @@ START_TEST(converter)
     test_conversion(&testdata_32bppBGRA, &testdata_32bppBGR, "BGRA -> BGR", 0);
     test_conversion(&testdata_32bppBGR, &testdata_32bppBGRA, "BGR -> BGRA", 0);
     test_conversion(&testdata_32bppBGRA, &testdata_32bppBGRA, "BGRA -> BGRA", 0);
+    test_conversion(&testdata_24bppBGR, &testdata_32bppBGRA, "24bppBGR -> BGRA", 0);
+    test_conversion(&testdata_32bppBGRA, &testdata_24bppBGR, "BGRA -> 24bppBGR", 0);
+    test_conversion(&testdata_32bppBGR, &testdata_24bppBGR, "BGR -> 24bppBGR", 0);
     test_invalid_conversion();
     test_default_converter();
 
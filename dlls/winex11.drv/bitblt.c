@@ -1555,6 +1555,8 @@ DWORD get_pixmap_image( Pixmap pixmap, int width, int height, const XVisualInfo
 }
 
 
+#define MAX_DIRTY_RECTS 8
+
 struct x11drv_window_surface
 {
     struct window_surface header;
@@ -1562,6 +1564,8 @@ struct x11drv_window_surface
     GC                    gc;
     XImage               *image;
     RECT                  bounds;
+    RECT                  dirty[MAX_DIRTY_RECTS];  /* damaged areas not flushed yet */
+    unsigned int          dirty_count;
     BOOL                  byteswap;
     BOOL                  is_argb;
     COLORREF              color_key;
@@ -1807,6 +1811,69 @@ failed:
 }
 #endif /* HAVE_LIBXXSHM */
 
+static inline unsigned int rect_area( const RECT *rect )
+{
+    return (rect->right - rect->left) * (rect->bottom - rect->top);
+}
+
+/***********************************************************************
+ *           add_dirty_rect
+ *
+ * Move the bounds accumulated by the last drawing operation to the dirty
+ * rectangle list, so that unrelated parts of the window don't get merged
+ * into a single large upload. Must be called with the surface lock held.
+ */
+static void add_dirty_rect( struct x11drv_window_surface *surface )
+{
+    RECT rect = surface->bounds, tmp;
+    unsigned int i, best = 0, cost, best_cost = ~0u;
+    BOOL merged;
+
+    if (rect.left >= rect.right || rect.top >= rect.bottom) return;
+    reset_bounds( &surface->bounds );
+
+    for (i = 0; i < surface->dirty_count; i++)
+    {
+        UnionRect( &tmp, &surface->dirty[i], &rect );
+        cost = rect_area( &tmp ) - rect_area( &surface->dirty[i] );
+        /* merge when the combined rectangle adds little beyond the new area */
+        if (cost <= rect_area( &rect ) || IntersectRect( &tmp, &surface->dirty[i], &rect ))
+        {
+            best = i;
+            best_cost = 0;
+            break;
+        }
+        if (cost < best_cost)
+        {
+            best = i;
+            best_cost = cost;
+        }
+    }
+
+    if (best_cost && surface->dirty_count < MAX_DIRTY_RECTS)
+    {
+        surface->dirty[surface->dirty_count++] = rect;
+        return;
+    }
+
+    UnionRect( &surface->dirty[best], &surface->dirty[best], &rect );
+
+    /* the grown rectangle may now cover some of the others, and grows again with each merge */
+    do
+    {
+        merged = FALSE;
+        for (i = 0; i < surface->dirty_count; i++)
+        {
+            if (i == best || !IntersectRect( &tmp, &surface->dirty[i], &surface->dirty[best] )) continue;
+            UnionRect( &surface->dirty[best], &surface->dirty[best], &surface->dirty[i] );
+            surface->dirty[i] = surface->dirty[--surface->dirty_count];
+            if (best == surface->dirty_count) best = i;
+            merged = TRUE;
+            break;
+        }
+    } while (merged);
+}
+
 /***********************************************************************
  *           x11drv_surface_lock
  */
@@ -1824,6 +1891,7 @@ static void x11drv_surface_unlock( struct window_surface *window_surface )
 {
     struct x11drv_window_surface *surface = get_x11_surface( window_surface );
 
+    add_dirty_rect( surface );
     LeaveCriticalSection( &surface->crit );
 }
 
@@ -1879,63 +1947,105 @@ static void x11drv_surface_set_region( struct window_surface *window_surface, HR
     window_surface->funcs->unlock( window_surface );
 }
 
+/***********************************************************************
+ *           convert_rows
+ *
+ * Convert a band of rows of the surface bits to the X image format, if they differ.
+ */
+static void convert_rows( struct x11drv_window_surface *surface, int top, int bottom )
+{
+    unsigned char *src = surface->bits;
+    unsigned char *dst = (unsigned char *)surface->image->data;
+    const int *mapping = NULL;
+    int width_bytes = surface->image->bytes_per_line;
+
+    if (src == dst) return;
+
+    if (surface->image->bits_per_pixel == 4 || surface->image->bits_per_pixel == 8)
+        mapping = X11DRV_PALETTE_PaletteToXPixel;
+
+    src += top * width_bytes;
+    dst += top * width_bytes;
+    copy_image_byteswap( &surface->info, src, dst, width_bytes, width_bytes,
+                         bottom - top, surface->byteswap, mapping, ~0u );
+}
+
+/***********************************************************************
+ *           flush_rect
+ */
+static void flush_rect( struct x11drv_window_surface *surface, const RECT *rect )
+{
+#ifdef HAVE_LIBXXSHM
+    if (surface->shminfo.shmid != -1)
+        XShmPutImage( gdi_display, surface->window, surface->gc, surface->image,
+                      rect->left, rect->top,
+                      surface->header.rect.left + rect->left,
+                      surface->header.rect.top + rect->top,
+                      rect->right - rect->left, rect->bottom - rect->top, False );
+    else
+#endif
+    XPutImage( gdi_display, surface->window, surface->gc, surface->image,
+               rect->left, rect->top,
+               surface->header.rect.left + rect->left,
+               surface->header.rect.top + rect->top,
+               rect->right - rect->left, rect->bottom - rect->top );
+}
+
 /***********************************************************************
  *           x11drv_surface_flush
  */
 static void x11drv_surface_flush( struct window_surface *window_surface )
 {
     struct x11drv_window_surface *surface = get_x11_surface( window_surface );
-    unsigned char *src = surface->bits;
-    unsigned char *dst = (unsigned char *)surface->image->data;
-    struct bitblt_coords coords;
+    RECT surface_rect, rects[MAX_DIRTY_RECTS], tmp;
+    unsigned int i, j, count = 0, pixels = 0;
+    int top, bottom;
 
     window_surface->funcs->lock( window_surface );
-    coords.x = 0;
-    coords.y = 0;
-    coords.width  = surface->header.rect.right - surface->header.rect.left;
-    coords.height = surface->header.rect.bottom - surface->header.rect.top;
-    SetRect( &coords.visrect, 0, 0, coords.width, coords.height );
-    if (IntersectRect( &coords.visrect, &coords.visrect, &surface->bounds ))
+    add_dirty_rect( surface );
+    SetRect( &surface_rect, 0, 0, surface->header.rect.right - surface->header.rect.left,
+             surface->header.rect.bottom - surface->header.rect.top );
+
+    /* keep the visible rectangles sorted by their top row */
+    for (i = 0; i < surface->dirty_count; i++)
     {
-        TRACE( "flushing %p %dx%d bounds %s bits %p\n",
-               surface, coords.width, coords.height,
-               wine_dbgstr_rect( &surface->bounds ), surface->bits );
+        if (!IntersectRect( &tmp, &surface_rect, &surface->dirty[i] )) continue;
+        for (j = count++; j > 0 && rects[j - 1].top > tmp.top; j--) rects[j] = rects[j - 1];
+        rects[j] = tmp;
+    }
 
+    if (count)
+    {
         if (surface->is_argb || surface->color_key != CLR_INVALID) update_surface_region( surface );
 
-        if (src != dst)
+        /* rows are converted whole, so convert each band of rows only once
+         * even when it is shared by several rectangles */
+        top = rects[0].top;
+        bottom = rects[0].bottom;
+        for (i = 1; i < count; i++)
         {
-            const int *mapping = NULL;
-            int width_bytes = surface->image->bytes_per_line;
-
-            if (surface->image->bits_per_pixel == 4 || surface->image->bits_per_pixel == 8)
-                mapping = X11DRV_PALETTE_PaletteToXPixel;
-
-            src += coords.visrect.top * width_bytes;
-            dst += coords.visrect.top * width_bytes;
-            copy_image_byteswap( &surface->info, src, dst, width_bytes, width_bytes,
-                                 coords.visrect.bottom - coords.visrect.top,
-                                 surface->byteswap, mapping, ~0u );
+            if (rects[i].top > bottom)
+            {
+                convert_rows( surface, top, bottom );
+                top = rects[i].top;
+            }
+            bottom = max( bottom, rects[i].bottom );
         }
+        convert_rows( surface, top, bottom );
+    }
 
-#ifdef HAVE_LIBXXSHM
-        if (surface->shminfo.shmid != -1)
-            XShmPutImage( gdi_display, surface->window, surface->gc, surface->image,
-                          coords.visrect.left, coords.visrect.top,
-                          surface->header.rect.left + coords.visrect.left,
-                          surface->header.rect.top + coords.visrect.top,
-                          coords.visrect.right - coords.visrect.left,
-                          coords.visrect.bottom - coords.visrect.top, False );
-        else
-#endif
-        XPutImage( gdi_display, surface->window, surface->gc, surface->image,
-                   coords.visrect.left, coords.visrect.top,
-                   surface->header.rect.left + coords.visrect.left,
-                   surface->header.rect.top + coords.visrect.top,
-                   coords.visrect.right - coords.visrect.left,
-                   coords.visrect.bottom - coords.visrect.top );
+    for (i = 0; i < count; i++)
+    {
+        TRACE( "flushing %p %dx%d rect %s bits %p\n", surface, surface_rect.right,
+               surface_rect.bottom, wine_dbgstr_rect( &rects[i] ), surface->bits );
+        flush_rect( surface, &rects[i] );
+        pixels += rect_area( &rects[i] );
     }
-    reset_bounds( &surface->bounds );
+
+    if (pixels)
+        TRACE( "%p: uploaded %u of %u pixels in %u rects\n",
+               surface, pixels, rect_area( &surface_rect ), count );
+    surface->dirty_count = 0;
     window_surface->funcs->unlock( window_surface );
 }
 
@@ -127,6 +127,9 @@ MAKE_FUNCPTR( SSL_CTX_set_default_verify_paths );
 MAKE_FUNCPTR( SSL_CTX_set_verify );
 MAKE_FUNCPTR( SSL_get_current_cipher );
 MAKE_FUNCPTR( SSL_CIPHER_get_bits );
+MAKE_FUNCPTR( SSL_get1_session );
+MAKE_FUNCPTR( SSL_set_session );
+MAKE_FUNCPTR( SSL_SESSION_free );
 
 MAKE_FUNCPTR( CRYPTO_num_locks );
 MAKE_FUNCPTR( CRYPTO_set_id_callback );
@@ -157,6 +160,96 @@ static void ssl_lock_callback(int mode, int type, const char *file, int line)
         LeaveCriticalSection( &ssl_locks[type] );
 }
 
+/* sessions of fully verified connections, resumed by later connections to the same server */
+struct cached_session
+{
+    struct list entry;
+    WCHAR *hostname;
+    INTERNET_PORT port;
+    SSL_SESSION *session;
+};
+
+#define MAX_CACHED_SESSIONS 64
+
+static struct list session_cache = LIST_INIT( session_cache );
+
+static CRITICAL_SECTION session_cache_cs;
+static CRITICAL_SECTION_DEBUG session_cache_cs_debug =
+{
+    0, 0, &session_cache_cs,
+    { &session_cache_cs_debug.ProcessLocksList,
+      &session_cache_cs_debug.ProcessLocksList },
+    0, 0, { (DWORD_PTR)(__FILE__ ": session_cache_cs") }
+};
+static CRITICAL_SECTION session_cache_cs = { &session_cache_cs_debug, -1, 0, 0, 0, 0 };
+
+/* certificate errors that may be ignored, sessions of such connections aren't cached */
+#define IGNORE_CERT_ERROR_FLAGS \
+    (SECURITY_FLAG_IGNORE_UNKNOWN_CA | SECURITY_FLAG_IGNORE_CERT_DATE_INVALID | \
+     SECURITY_FLAG_IGNORE_CERT_CN_INVALID | SECURITY_FLAG_IGNORE_CERT_WRONG_USAGE)
+
+static void free_cached_session( struct cached_session *cached )
+{
+    list_remove( &cached->entry );
+    pSSL_SESSION_free( cached->session );
+    heap_free( cached->hostname );
+    heap_free( cached );
+}
+
+static void resume_session( SSL *ssl, const WCHAR *hostname, INTERNET_PORT port )
+{
+    struct cached_session *cached;
+
+    EnterCriticalSection( &session_cache_cs );
+    LIST_FOR_EACH_ENTRY( cached, &session_cache, struct cached_session, entry )
+    {
+        if (cached->port == port && !strcmpiW( cached->hostname, hostname ))
+        {
+            TRACE("resuming session for %s:%u\n", debugstr_w(hostname), port);
+            pSSL_set_session( ssl, cached->session );
+            break;
+        }
+    }
+    LeaveCriticalSection( &session_cache_cs );
+}
+
+static void cache_session( SSL *ssl, const WCHAR *hostname, INTERNET_PORT port )
+{
+    struct cached_session *cached;
+    SSL_SESSION *session;
+
+    if (!(session = pSSL_get1_session( ssl ))) return;
+
+    EnterCriticalSection( &session_cache_cs );
+    LIST_FOR_EACH_ENTRY( cached, &session_cache, struct cached_session, entry )
+    {
+        if (cached->port == port && !strcmpiW( cached->hostname, hostname ))
+        {
+            pSSL_SESSION_free( cached->session );
+            cached->session = session;
+            list_remove( &cached->entry );
+            list_add_head( &session_cache, &cached->entry );
+            LeaveCriticalSection( &session_cache_cs );
+            return;
+        }
+    }
+    if (list_count( &session_cache ) >= MAX_CACHED_SESSIONS)
+        free_cached_session( LIST_ENTRY( list_tail( &session_cache ), struct cached_session, entry ) );
+
+    if (!(cached = heap_alloc( sizeof(*cached) )) || !(cached->hostname = strdupW( hostname )))
+    {
+        heap_free( cached );
+        pSSL_SESSION_free( session );
+    }
+    else
+    {
+        cached->port = port;
+        cached->session = session;
+        list_add_head( &session_cache, &cached->entry );
+    }
+    LeaveCriticalSection( &session_cache_cs );
+}
+
 #endif
 
 /* translate a unix error code into a winsock error code */
@@ -471,6 +564,9 @@ BOOL netconn_init( netconn_t *conn, BOOL secure )
     LOAD_FUNCPTR( SSL_CTX_set_verify );
     LOAD_FUNCPTR( SSL_get_current_cipher );
     LOAD_FUNCPTR( SSL_CIPHER_get_bits );
+    LOAD_FUNCPTR( SSL_get1_session );
+    LOAD_FUNCPTR( SSL_set_session );
+    LOAD_FUNCPTR( SSL_SESSION_free );
 #undef LOAD_FUNCPTR
 
 #define LOAD_FUNCPTR(x) \
@@ -567,6 +663,8 @@ void netconn_unload( void )
     }
     if (libssl_handle)
     {
+        while (!list_empty( &session_cache ))
+            free_cached_session( LIST_ENTRY( list_head( &session_cache ), struct cached_session, entry ) );
         if (ctx)
             pSSL_CTX_free( ctx );
         wine_dlclose( libssl_handle, NULL, 0 );
@@ -593,6 +691,35 @@ BOOL netconn_connected( netconn_t *conn )
     return (conn->socket != -1);
 }
 
+/* an idle connection has nothing to read, pending data or end of file means it can't be reused */
+BOOL netconn_is_alive( netconn_t *conn )
+{
+    struct pollfd pfd;
+
+    if (!netconn_connected( conn )) return FALSE;
+    if (conn->secure)
+    {
+#ifdef SONAME_LIBSSL
+        if (conn->peek_len || pSSL_pending( conn->ssl_conn )) return FALSE;
+#endif
+    }
+    pfd.fd = conn->socket;
+    pfd.events = POLLIN;
+    pfd.revents = 0;
+    return !poll( &pfd, 1, 0 );
+}
+
+/* netconn_t is copied by value when a connection is pooled or reused, so the
+ * certificate verification callback has to be pointed at the new owner */
+void netconn_set_owner( netconn_t *conn, WCHAR *hostname )
+{
+#ifdef SONAME_LIBSSL
+    if (!conn->secure) return;
+    pSSL_set_ex_data( conn->ssl_conn, hostname_idx, hostname );
+    pSSL_set_ex_data( conn->ssl_conn, conn_idx, conn );
+#endif
+}
+
 BOOL netconn_create( netconn_t *conn, int domain, int type, int protocol )
 {
     if ((conn->socket = socket( domain, type, protocol )) == -1)
@@ -673,7 +800,8 @@ BOOL netconn_connect( netconn_t *conn, const struct sockaddr *sockaddr, unsigned
     return ret;
 }
 
-BOOL netconn_secure_connect( netconn_t *conn, WCHAR *hostname )
+/* sessions are resumed and cached per hostname and port only if reuse_session is set */
+BOOL netconn_secure_connect( netconn_t *conn, WCHAR *hostname, INTERNET_PORT port, BOOL reuse_session )
 {
 #ifdef SONAME_LIBSSL
     if (!(conn->ssl_conn = pSSL_new( ctx )))
@@ -700,6 +828,7 @@ BOOL netconn_secure_connect( netconn_t *conn, WCHAR *hostname )
         set_last_error( ERROR_WINHTTP_SECURE_CHANNEL_ERROR );
         goto fail;
     }
+    if (reuse_session) resume_session( conn->ssl_conn, hostname, port );
     if (pSSL_connect( conn->ssl_conn ) <= 0)
     {
         DWORD err;
@@ -712,6 +841,9 @@ BOOL netconn_secure_connect( netconn_t *conn, WCHAR *hostname )
     }
     TRACE("established SSL connection\n");
     conn->secure = TRUE;
+
+    if (reuse_session && !(conn->security_flags & IGNORE_CERT_ERROR_FLAGS))
+        cache_session( conn->ssl_conn, hostname, port );
     return TRUE;
 
 fail:
@@ -935,7 +935,180 @@ static WCHAR *addr_to_str( const struct sockaddr *addr )
     return strdupAW( buf );
 }
 
-static BOOL open_connection( request_t *request )
+/* idle keep-alive connections, reused by requests to the same server */
+typedef struct
+{
+    struct list entry;
+    WCHAR *servername;
+    INTERNET_PORT port;
+    BOOL secure;
+    ULONGLONG keep_until;
+    netconn_t netconn;
+} pooled_connection_t;
+
+/* how long idle connections are kept in the pool, shorter than the keep-alive timeout of most servers */
+#define CONNECTION_POOL_TIMEOUT 4000
+
+static struct list connection_pool = LIST_INIT( connection_pool );
+
+static CRITICAL_SECTION connection_pool_cs;
+static CRITICAL_SECTION_DEBUG connection_pool_cs_debug =
+{
+    0, 0, &connection_pool_cs,
+    { &connection_pool_cs_debug.ProcessLocksList, &connection_pool_cs_debug.ProcessLocksList },
+      0, 0, { (DWORD_PTR)(__FILE__ ": connection_pool_cs") }
+};
+static CRITICAL_SECTION connection_pool_cs = { &connection_pool_cs_debug, -1, 0, 0, 0, 0 };
+
+static void free_pooled_connection( pooled_connection_t *conn )
+{
+    netconn_close( &conn->netconn );
+    heap_free( conn->servername );
+    heap_free( conn );
+}
+
+/* closing a connection may block, so it's done after the entries are unlinked
+ * from the pool and connection_pool_cs is released */
+static void free_pooled_connections( struct list *list )
+{
+    pooled_connection_t *conn, *next;
+
+    LIST_FOR_EACH_ENTRY_SAFE( conn, next, list, pooled_connection_t, entry )
+    {
+        list_remove( &conn->entry );
+        free_pooled_connection( conn );
+    }
+}
+
+/* must be called with connection_pool_cs held */
+static void expire_pooled_connections( struct list *expired )
+{
+    pooled_connection_t *conn, *next;
+    ULONGLONG now = GetTickCount64();
+
+    LIST_FOR_EACH_ENTRY_SAFE( conn, next, &connection_pool, pooled_connection_t, entry )
+    {
+        if (conn->keep_until >= now) continue;
+        list_remove( &conn->entry );
+        list_add_tail( expired, &conn->entry );
+    }
+}
+
+static INTERNET_PORT get_server_port( request_t *request )
+{
+    connect_t *connect = request->connect;
+    return connect->serverport ? connect->serverport : (request->hdr.flags & WINHTTP_FLAG_SECURE ? 443 : 80);
+}
+
+static pooled_connection_t *take_pooled_connection( request_t *request, struct list *expired )
+{
+    connect_t *connect = request->connect;
+    INTERNET_PORT port = get_server_port( request );
+    BOOL secure = (request->hdr.flags & WINHTTP_FLAG_SECURE) != 0;
+    pooled_connection_t *conn, *ret = NULL;
+
+    EnterCriticalSection( &connection_pool_cs );
+
+    expire_pooled_connections( expired );
+    LIST_FOR_EACH_ENTRY( conn, &connection_pool, pooled_connection_t, entry )
+    {
+        if (conn->port != port || conn->secure != secure || strcmpiW( conn->servername, connect->servername ) ||
+            conn->netconn.security_flags != request->netconn.security_flags) continue;
+
+        list_remove( &conn->entry );
+        ret = conn;
+        break;
+    }
+
+    LeaveCriticalSection( &connection_pool_cs );
+    return ret;
+}
+
+static BOOL get_pooled_connection( request_t *request )
+{
+    struct list expired = LIST_INIT( expired );
+    pooled_connection_t *conn;
+
+    while ((conn = take_pooled_connection( request, &expired )))
+    {
+        if (netconn_is_alive( &conn->netconn )) break;
+
+        TRACE("dropping closed connection to %s:%u\n", debugstr_w(conn->servername), conn->port);
+        free_pooled_connection( conn );
+    }
+    free_pooled_connections( &expired );
+    if (!conn) return FALSE;
+
+    TRACE("reusing connection to %s:%u\n", debugstr_w(conn->servername), conn->port);
+
+    request->netconn = conn->netconn;
+    netconn_set_owner( &request->netconn, request->connect->servername );
+    heap_free( conn->servername );
+    heap_free( conn );
+
+    netconn_set_timeout( &request->netconn, TRUE, request->send_timeout );
+    netconn_set_timeout( &request->netconn, FALSE, request->recv_timeout );
+    return TRUE;
+}
+
+/* hand the connection over to the pool if the response has been read completely, close it otherwise */
+void release_connection( request_t *request )
+{
+    struct list expired = LIST_INIT( expired );
+    connect_t *connect = request->connect;
+    pooled_connection_t *conn;
+    DWORD security_flags;
+
+    if (!netconn_connected( &request->netconn )) return;
+
+    /* connections tunneled through a proxy are specific to the destination host */
+    if (!request->keep_alive || ((request->hdr.flags & WINHTTP_FLAG_SECURE) &&
+        connect->session->proxy_server && strcmpiW( connect->hostname, connect->servername )))
+    {
+        close_connection( request );
+        return;
+    }
+
+    if (!(conn = heap_alloc( sizeof(*conn) )) || !(conn->servername = strdupW( connect->servername )))
+    {
+        heap_free( conn );
+        close_connection( request );
+        return;
+    }
+    conn->port = get_server_port( request );
+    conn->secure = (request->hdr.flags & WINHTTP_FLAG_SECURE) != 0;
+    conn->keep_until = GetTickCount64() + CONNECTION_POOL_TIMEOUT;
+    conn->netconn = request->netconn;
+    netconn_set_owner( &conn->netconn, conn->servername );
+
+    security_flags = request->netconn.security_flags;
+    memset( &request->netconn, 0, sizeof(request->netconn) );
+    netconn_init( &request->netconn, FALSE );
+    request->netconn.security_flags = security_flags;
+    request->keep_alive = FALSE;
+
+    TRACE("pooling connection to %s:%u\n", debugstr_w(conn->servername), conn->port);
+
+    EnterCriticalSection( &connection_pool_cs );
+    expire_pooled_connections( &expired );
+    list_add_head( &connection_pool, &conn->entry );
+    LeaveCriticalSection( &connection_pool_cs );
+
+    free_pooled_connections( &expired );
+}
+
+void free_connection_pool( void )
+{
+    struct list pool = LIST_INIT( pool );
+
+    EnterCriticalSection( &connection_pool_cs );
+    list_move_tail( &pool, &connection_pool );
+    LeaveCriticalSection( &connection_pool_cs );
+
+    free_pooled_connections( &pool );
+}
+
+static BOOL open_connection( request_t *request, BOOL use_pool )
 {
     connect_t *connect;
     WCHAR *addressW = NULL;
@@ -945,9 +1118,15 @@ static BOOL open_connection( request_t *request )
     DWORD len;
 
     if (netconn_connected( &request->netconn )) return TRUE;
+    if (use_pool && get_pooled_connection( request ))
+    {
+        request->may_resend = TRUE;
+        return TRUE;
+    }
+    request->may_resend = FALSE;
 
     connect = request->connect;
-    port = connect->serverport ? connect->serverport : (request->hdr.flags & WINHTTP_FLAG_SECURE ? 443 : 80);
+    port = get_server_port( request );
     saddr = (struct sockaddr *)&connect->sockaddr;
     slen = sizeof(struct sockaddr);
 
@@ -983,8 +1162,9 @@ static BOOL open_connection( request_t *request )
     }
     if (request->hdr.flags & WINHTTP_FLAG_SECURE)
     {
-        if (connect->session->proxy_server &&
-            strcmpiW( connect->hostname, connect->servername ))
+        BOOL tunnel = connect->session->proxy_server && strcmpiW( connect->hostname, connect->servername );
+
+        if (tunnel)
         {
             if (!secure_proxy_connect( request ))
             {
@@ -992,7 +1172,8 @@ static BOOL open_connection( request_t *request )
                 return FALSE;
             }
         }
-        if (!netconn_secure_connect( &request->netconn, connect->servername ))
+        /* the session cache is keyed on the server we connect to, which is shared by all tunneled hosts */
+        if (!netconn_secure_connect( &request->netconn, connect->servername, port, !tunnel ))
         {
             netconn_close( &request->netconn );
             heap_free( addressW );
@@ -1092,7 +1273,8 @@ static BOOL send_request( request_t *request, LPCWSTR headers, DWORD headers_len
 
     if (context) request->hdr.context = context;
 
-    if (!(ret = open_connection( request ))) goto end;
+    request->keep_alive = FALSE;
+    if (!(ret = open_connection( request, TRUE ))) goto end;
     if (!(req = build_request_string( request ))) goto end;
 
     if (!(req_ascii = strdupWA( req ))) goto end;
@@ -1102,12 +1284,22 @@ static BOOL send_request( request_t *request, LPCWSTR headers, DWORD headers_len
     send_callback( &request->hdr, WINHTTP_CALLBACK_STATUS_SENDING_REQUEST, NULL, 0 );
 
     ret = netconn_send( &request->netconn, req_ascii, len, 0, &bytes_sent );
+    if (!ret && request->may_resend)
+    {
+        TRACE("pooled connection was closed, resending request on a new connection\n");
+        close_connection( request );
+        if ((ret = open_connection( request, FALSE )))
+            ret = netconn_send( &request->netconn, req_ascii, len, 0, &bytes_sent );
+    }
     heap_free( req_ascii );
     if (!ret) goto end;
 
     if (optional_len && !netconn_send( &request->netconn, optional, optional_len, 0, &bytes_sent )) goto end;
     len += optional_len;
 
+    /* the request body isn't kept around, so such requests can't be resent */
+    if (total_len || optional_len) request->may_resend = FALSE;
+
     send_callback( &request->hdr, WINHTTP_CALLBACK_STATUS_REQUEST_SENT, &len, sizeof(DWORD) );
 
 end:
@@ -1494,6 +1686,7 @@ static BOOL read_reply( request_t *request )
         buflen = MAX_REPLY_LEN;
         if (!netconn_get_next_line( &request->netconn, buffer, &buflen )) return FALSE;
         received_len += buflen;
+        request->may_resend = FALSE;
 
         /* first line should look like 'HTTP/1.x nnn OK' where nnn is the status code */
         if (!(status_code = strchr( buffer, ' ' ))) return FALSE;
@@ -1639,7 +1832,7 @@ static BOOL handle_redirect( request_t *request, DWORD status )
             if (!(ret = netconn_init( &request->netconn, request->hdr.flags & WINHTTP_FLAG_SECURE ))) goto end;
         }
         if (!(ret = add_host_header( request, WINHTTP_ADDREQ_FLAG_REPLACE ))) goto end;
-        if (!(ret = open_connection( request ))) goto end;
+        if (!(ret = open_connection( request, TRUE ))) goto end;
 
         heap_free( request->path );
         request->path = NULL;
@@ -1764,6 +1957,21 @@ static BOOL receive_data_chunked( request_t *request, void *buffer, DWORD size,
     return TRUE;
 }
 
+/* the end of the response is known without the server closing the connection */
+static BOOL is_length_delimited( request_t *request )
+{
+    static const WCHAR chunked[] = {'c','h','u','n','k','e','d',0};
+
+    WCHAR encoding[20];
+    DWORD length, size = sizeof(encoding);
+
+    if (query_headers( request, WINHTTP_QUERY_TRANSFER_ENCODING, NULL, encoding, &size, NULL ) &&
+        !strcmpiW( encoding, chunked )) return TRUE;
+
+    size = sizeof(length);
+    return query_headers( request, WINHTTP_QUERY_CONTENT_LENGTH | WINHTTP_QUERY_FLAG_NUMBER, NULL, &length, &size, NULL );
+}
+
 static void finished_reading( request_t *request )
 {
     static const WCHAR closeW[] = {'c','l','o','s','e',0};
@@ -1781,6 +1989,7 @@ static void finished_reading( request_t *request )
     else if (!strcmpW( request->version, http1_0 )) close = TRUE;
 
     if (close) close_connection( request );
+    else request->keep_alive = is_length_delimited( request );
     request->content_length = ~0u;
     request->content_read = 0;
 }
@@ -1860,6 +2069,14 @@ static BOOL receive_response( request_t *request, BOOL async )
     {
         if (!(ret = read_reply( request )))
         {
+            if (request->may_resend)
+            {
+                /* the server closed the pooled connection without responding */
+                TRACE("resending request on a new connection\n");
+                close_connection( request );
+                if (open_connection( request, FALSE ) && send_request( request, NULL, 0, NULL, 0, 0, 0, FALSE ))
+                    continue;
+            }
             set_last_error( ERROR_WINHTTP_INVALID_SERVER_RESPONSE );
             break;
         }
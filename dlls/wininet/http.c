@@ -247,6 +247,7 @@ void server_release(server_t *server)
 
     if(server->cert_chain)
         CertFreeCertificateChain(server->cert_chain);
+    NETCON_free_session(server);
     heap_free(server->name);
     heap_free(server->scheme_host_port);
     heap_free(server);
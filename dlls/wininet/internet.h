@@ -71,6 +71,7 @@ typedef struct {
 
     DWORD security_flags;
     const CERT_CHAIN_CONTEXT *cert_chain;
+    void *ssl_session; /* session of the last verified connection, used for resumption */
 
     struct list entry;
     struct list conn_pool;
@@ -539,6 +540,7 @@ DWORD create_netconn(BOOL,server_t*,DWORD,BOOL,DWORD,netconn_t**) DECLSPEC_HIDDE
 void free_netconn(netconn_t*) DECLSPEC_HIDDEN;
 void NETCON_unload(void) DECLSPEC_HIDDEN;
 DWORD NETCON_secure_connect(netconn_t*,server_t*) DECLSPEC_HIDDEN;
+void NETCON_free_session(server_t*) DECLSPEC_HIDDEN;
 DWORD NETCON_send(netconn_t *connection, const void *msg, size_t len, int flags,
 		int *sent /* out */) DECLSPEC_HIDDEN;
 DWORD NETCON_recv(netconn_t *connection, void *buf, size_t len, int flags,
@@ -146,6 +146,9 @@ MAKE_FUNCPTR(SSL_CTX_set_default_verify_paths);
 MAKE_FUNCPTR(SSL_CTX_set_verify);
 MAKE_FUNCPTR(SSL_get_current_cipher);
 MAKE_FUNCPTR(SSL_CIPHER_get_bits);
+MAKE_FUNCPTR(SSL_get1_session);
+MAKE_FUNCPTR(SSL_set_session);
+MAKE_FUNCPTR(SSL_SESSION_free);
 
 /* OpenSSL's libcrypto functions that we use */
 MAKE_FUNCPTR(BIO_new_fp);
@@ -178,6 +181,24 @@ static void ssl_lock_callback(int mode, int type, const char *file, int line)
         LeaveCriticalSection(&ssl_locks[type]);
 }
 
+/* protects server_t ssl_session */
+static CRITICAL_SECTION ssl_session_cs;
+static CRITICAL_SECTION_DEBUG ssl_session_cs_debug =
+{
+    0, 0, &ssl_session_cs,
+    { &ssl_session_cs_debug.ProcessLocksList,
+      &ssl_session_cs_debug.ProcessLocksList },
+    0, 0, { (DWORD_PTR)(__FILE__ ": ssl_session_cs") }
+};
+static CRITICAL_SECTION ssl_session_cs = { &ssl_session_cs_debug, -1, 0, 0, 0, 0 };
+
+/* certificate errors that may be ignored, sessions of such connections aren't reused */
+#define IGNORE_CERT_ERROR_FLAGS                 \
+    (SECURITY_FLAG_IGNORE_UNKNOWN_CA            \
+    |SECURITY_FLAG_IGNORE_WRONG_USAGE           \
+    |SECURITY_FLAG_IGNORE_CERT_CN_INVALID       \
+    |SECURITY_FLAG_IGNORE_CERT_DATE_INVALID)
+
 static PCCERT_CONTEXT X509_to_cert_context(X509 *cert)
 {
     unsigned char* buffer,*p;
@@ -558,6 +579,9 @@ static DWORD init_openssl(void)
     DYNSSL(SSL_CTX_set_verify);
     DYNSSL(SSL_get_current_cipher);
     DYNSSL(SSL_CIPHER_get_bits);
+    DYNSSL(SSL_get1_session);
+    DYNSSL(SSL_set_session);
+    DYNSSL(SSL_SESSION_free);
 #undef DYNSSL
 
 #define DYNCRYPTO(x) \
@@ -739,6 +763,17 @@ void free_netconn(netconn_t *netconn)
     heap_free(netconn);
 }
 
+void NETCON_free_session(server_t *server)
+{
+#ifdef SONAME_LIBSSL
+    if (server->ssl_session)
+    {
+        pSSL_SESSION_free(server->ssl_session);
+        server->ssl_session = NULL;
+    }
+#endif
+}
+
 void NETCON_unload(void)
 {
 #if defined(SONAME_LIBSSL) && defined(SONAME_LIBCRYPTO)
@@ -864,6 +899,13 @@ static DWORD netcon_secure_connect_setup(netconn_t *connection, long tls_option)
         res = ERROR_INTERNET_SECURITY_CHANNEL_ERROR;
         goto fail;
     }
+
+    /* resume the last session with this server to save a full handshake */
+    EnterCriticalSection(&ssl_session_cs);
+    if (connection->server->ssl_session)
+        pSSL_set_session(ssl_s, connection->server->ssl_session);
+    LeaveCriticalSection(&ssl_session_cs);
+
     if (pSSL_connect(ssl_s) <= 0)
     {
         res = (DWORD_PTR)pSSL_get_ex_data(ssl_s, error_idx);
@@ -886,6 +928,18 @@ static DWORD netcon_secure_connect_setup(netconn_t *connection, long tls_option)
 
     if(connection->mask_errors)
         connection->server->security_flags = connection->security_flags;
+
+    /* only sessions of fully verified connections may skip verification later */
+    if (!(connection->security_flags & (IGNORE_CERT_ERROR_FLAGS|_SECURITY_ERROR_FLAGS_MASK)))
+    {
+        SSL_SESSION *session = pSSL_get1_session(ssl_s);
+
+        EnterCriticalSection(&ssl_session_cs);
+        if (connection->server->ssl_session)
+            pSSL_SESSION_free(connection->server->ssl_session);
+        connection->server->ssl_session = session;
+        LeaveCriticalSection(&ssl_session_cs);
+    }
     return ERROR_SUCCESS;
 
 fail:
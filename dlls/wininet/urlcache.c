@@ -197,6 +197,7 @@ typedef struct _URLCACHECONTAINER
     LPWSTR cache_prefix; /* string that has to be prefixed for this container to be used */
     LPWSTR path; /* path to url container directory */
     HANDLE hMapping; /* handle of file mapping */
+    URLCACHE_HEADER *header; /* view of the index, kept mapped until the index is closed */
     DWORD file_size; /* size of file when mapping was opened */
     HANDLE hMutex; /* handle of mutex */
     DWORD default_entry_type;
@@ -247,6 +248,11 @@ static DWORD URLCacheContainer_OpenIndex(URLCACHECONTAINER * pContainer, DWORD b
     static const WCHAR wszIndex[] = {'i','n','d','e','x','.','d','a','t',0};
     static const WCHAR wszMappingFormat[] = {'%','s','%','s','_','%','l','u',0};
 
+    /* The index is only closed with the mutex held and LockIndex
+     * reopens it when needed, so don't wait for the mutex if it's open. */
+    if (pContainer->hMapping)
+        return ERROR_SUCCESS;
+
     WaitForSingleObject(pContainer->hMutex, INFINITE);
 
     if (pContainer->hMapping) {
@@ -511,7 +517,7 @@ static DWORD URLCacheContainer_OpenIndex(URLCACHECONTAINER * pContainer, DWORD b
 /***********************************************************************
  *           URLCacheContainer_CloseIndex (Internal)
  *
- *  Closes the index
+ *  Unmaps the index view and closes the index
  *
  * RETURNS
  *    nothing
@@ -519,8 +525,16 @@ static DWORD URLCacheContainer_OpenIndex(URLCACHECONTAINER * pContainer, DWORD b
  */
 static void URLCacheContainer_CloseIndex(URLCACHECONTAINER * pContainer)
 {
-    CloseHandle(pContainer->hMapping);
-    pContainer->hMapping = NULL;
+    if (pContainer->header)
+    {
+        UnmapViewOfFile(pContainer->header);
+        pContainer->header = NULL;
+    }
+    if (pContainer->hMapping)
+    {
+        CloseHandle(pContainer->hMapping);
+        pContainer->hMapping = NULL;
+    }
 }
 
 static BOOL URLCacheContainers_AddContainer(LPCWSTR cache_prefix,
@@ -535,6 +549,7 @@ static BOOL URLCacheContainers_AddContainer(LPCWSTR cache_prefix,
     }
 
     pContainer->hMapping = NULL;
+    pContainer->header = NULL;
     pContainer->file_size = 0;
     pContainer->default_entry_type = default_entry_type;
 
@@ -721,6 +736,41 @@ static BOOL URLCacheContainers_Enum(LPCWSTR lpwszSearchPattern, DWORD dwIndex, U
     return FALSE;
 }
 
+/***********************************************************************
+ *           URLCacheContainer_MapIndex (Internal)
+ *
+ * Maps the index view if it isn't mapped yet. The view stays mapped
+ * until the index is closed. Must be called with the mutex held.
+ *
+ * RETURNS
+ *  Cache file header if successful
+ *  NULL if failed and calls SetLastError.
+ */
+static URLCACHE_HEADER *URLCacheContainer_MapIndex(URLCACHECONTAINER *pContainer)
+{
+    DWORD error;
+
+    if (!pContainer->hMapping)
+    {
+        URLCacheContainer_CloseIndex(pContainer);
+        error = URLCacheContainer_OpenIndex(pContainer, MIN_BLOCK_NO);
+        if (error != ERROR_SUCCESS)
+        {
+            SetLastError(error);
+            return NULL;
+        }
+    }
+
+    if (!pContainer->header)
+    {
+        pContainer->header = MapViewOfFile(pContainer->hMapping, FILE_MAP_WRITE, 0, 0, 0);
+        if (!pContainer->header)
+            ERR("Couldn't MapViewOfFile. Error: %d\n", GetLastError());
+    }
+
+    return pContainer->header;
+}
+
 /***********************************************************************
  *           URLCacheContainer_LockIndex (Internal)
  *
@@ -733,67 +783,54 @@ static BOOL URLCacheContainers_Enum(LPCWSTR lpwszSearchPattern, DWORD dwIndex, U
 static LPURLCACHE_HEADER URLCacheContainer_LockIndex(URLCACHECONTAINER * pContainer)
 {
     BYTE index;
-    LPVOID pIndexData;
     URLCACHE_HEADER * pHeader;
-    DWORD error;
 
     /* acquire mutex */
     WaitForSingleObject(pContainer->hMutex, INFINITE);
 
-    pIndexData = MapViewOfFile(pContainer->hMapping, FILE_MAP_WRITE, 0, 0, 0);
-
-    if (!pIndexData)
+    pHeader = URLCacheContainer_MapIndex(pContainer);
+    if (!pHeader)
     {
         ReleaseMutex(pContainer->hMutex);
-        ERR("Couldn't MapViewOfFile. Error: %d\n", GetLastError());
         return NULL;
     }
-    pHeader = (URLCACHE_HEADER *)pIndexData;
 
     /* file has grown - we need to remap to prevent us getting
      * access violations when we try and access beyond the end
      * of the memory mapped file */
     if (pHeader->dwFileSize != pContainer->file_size)
     {
-        UnmapViewOfFile( pHeader );
         URLCacheContainer_CloseIndex(pContainer);
-        error = URLCacheContainer_OpenIndex(pContainer, MIN_BLOCK_NO);
-        if (error != ERROR_SUCCESS)
+        pHeader = URLCacheContainer_MapIndex(pContainer);
+        if (!pHeader)
         {
             ReleaseMutex(pContainer->hMutex);
-            SetLastError(error);
             return NULL;
         }
-        pIndexData = MapViewOfFile(pContainer->hMapping, FILE_MAP_WRITE, 0, 0, 0);
+    }
 
-        if (!pIndexData)
+    if (TRACE_ON(wininet))
+    {
+        TRACE("Signature: %s, file size: %d bytes\n", pHeader->szSignature, pHeader->dwFileSize);
+
+        for (index = 0; index < pHeader->DirectoryCount; index++)
         {
-            ReleaseMutex(pContainer->hMutex);
-            ERR("Couldn't MapViewOfFile. Error: %d\n", GetLastError());
-            return NULL;
+            TRACE("Directory[%d] = \"%.8s\"\n", index, pHeader->directory_data[index].filename);
         }
-        pHeader = (URLCACHE_HEADER *)pIndexData;
     }
 
-    TRACE("Signature: %s, file size: %d bytes\n", pHeader->szSignature, pHeader->dwFileSize);
-
-    for (index = 0; index < pHeader->DirectoryCount; index++)
-    {
-        TRACE("Directory[%d] = \"%.8s\"\n", index, pHeader->directory_data[index].filename);
-    }
-    
     return pHeader;
 }
 
 /***********************************************************************
  *           URLCacheContainer_UnlockIndex (Internal)
  *
+ * The index view stays mapped, pHeader must not be used after unlocking.
  */
 static BOOL URLCacheContainer_UnlockIndex(URLCACHECONTAINER * pContainer, LPURLCACHE_HEADER pHeader)
 {
     /* release mutex */
-    ReleaseMutex(pContainer->hMutex);
-    return UnmapViewOfFile(pHeader);
+    return ReleaseMutex(pContainer->hMutex);
 }
 
 #ifndef CHAR_BIT
@@ -1127,7 +1164,7 @@ static BOOL urlcache_clean_leaked_entries(URLCACHECONTAINER *container, URLCACHE
 static DWORD URLCacheContainer_CleanIndex(URLCACHECONTAINER *container, URLCACHE_HEADER **file_view)
 {
     URLCACHE_HEADER *header = *file_view;
-    DWORD ret;
+    DWORD blocks_no, ret;
 
     TRACE("(%s %s)\n", debugstr_w(container->cache_prefix), debugstr_w(container->path));
 
@@ -1139,16 +1176,25 @@ static DWORD URLCacheContainer_CleanIndex(URLCACHECONTAINER *container, URLCACHE
         return ERROR_NOT_ENOUGH_MEMORY;
     }
 
+    /* keep the old view usable by the caller until the new one is mapped */
+    blocks_no = header->dwIndexCapacityInBlocks*2;
+    container->header = NULL;
     URLCacheContainer_CloseIndex(container);
-    ret = URLCacheContainer_OpenIndex(container, header->dwIndexCapacityInBlocks*2);
-    if(ret != ERROR_SUCCESS)
+    ret = URLCacheContainer_OpenIndex(container, blocks_no);
+    if(ret == ERROR_SUCCESS && !URLCacheContainer_MapIndex(container))
+        ret = GetLastError();
+    if(ret != ERROR_SUCCESS) {
+        /* the old view is dropped when LockIndex reopens the index */
+        if(container->hMapping) {
+            CloseHandle(container->hMapping);
+            container->hMapping = NULL;
+        }
+        container->header = header;
         return ret;
-    header = MapViewOfFile(container->hMapping, FILE_MAP_WRITE, 0, 0, 0);
-    if(!header)
-        return GetLastError();
+    }
 
-    UnmapViewOfFile(*file_view);
-    *file_view = header;
+    UnmapViewOfFile(header);
+    *file_view = container->header;
     return ERROR_SUCCESS;
 }
 
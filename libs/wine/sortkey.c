@@ -22,6 +22,12 @@
 extern int get_decomposition(WCHAR src, WCHAR *dst, unsigned int dstlen);
 extern const unsigned int collation_table[];
 
+/* look up the collation element of a character */
+static inline unsigned int get_collation_element(WCHAR wch)
+{
+    return collation_table[collation_table[wch >> 8] + (wch & 0xff)];
+}
+
 /*
  * flags - normalization NORM_* flags
  *
@@ -57,7 +63,7 @@ int wine_get_sortkey(int flags, const WCHAR *src, int srclen, char *dst, int dst
 
                 if (flags & NORM_IGNORECASE) wch = tolowerW(wch);
 
-                ce = collation_table[collation_table[wch >> 8] + (wch & 0xff)];
+                ce = get_collation_element(wch);
                 if (ce != (unsigned int)-1)
                 {
                     if (ce >> 16) key_len[0] += 2;
@@ -115,7 +121,7 @@ int wine_get_sortkey(int flags, const WCHAR *src, int srclen, char *dst, int dst
 
                 if (flags & NORM_IGNORECASE) wch = tolowerW(wch);
 
-                ce = collation_table[collation_table[wch >> 8] + (wch & 0xff)];
+                ce = get_collation_element(wch);
                 if (ce != (unsigned int)-1)
                 {
                     WCHAR key;
@@ -208,8 +214,8 @@ static inline int compare_unicode_weights(int flags, const WCHAR *str1, int len1
             }
         }
 
-        ce1 = collation_table[collation_table[*str1 >> 8] + (*str1 & 0xff)];
-        ce2 = collation_table[collation_table[*str2 >> 8] + (*str2 & 0xff)];
+        ce1 = get_collation_element(*str1);
+        ce2 = get_collation_element(*str2);
 
         if (ce1 != (unsigned int)-1 && ce2 != (unsigned int)-1)
             ret = (ce1 >> 16) - (ce2 >> 16);
@@ -257,8 +263,8 @@ static inline int compare_diacritic_weights(int flags, const WCHAR *str1, int le
             if (skip) continue;
         }
 
-        ce1 = collation_table[collation_table[*str1 >> 8] + (*str1 & 0xff)];
-        ce2 = collation_table[collation_table[*str2 >> 8] + (*str2 & 0xff)];
+        ce1 = get_collation_element(*str1);
+        ce2 = get_collation_element(*str2);
 
         if (ce1 != (unsigned int)-1 && ce2 != (unsigned int)-1)
             ret = ((ce1 >> 8) & 0xff) - ((ce2 >> 8) & 0xff);
@@ -306,8 +312,8 @@ static inline int compare_case_weights(int flags, const WCHAR *str1, int len1,
             if (skip) continue;
         }
 
-        ce1 = collation_table[collation_table[*str1 >> 8] + (*str1 & 0xff)];
-        ce2 = collation_table[collation_table[*str2 >> 8] + (*str2 & 0xff)];
+        ce1 = get_collation_element(*str1);
+        ce2 = get_collation_element(*str2);
 
         if (ce1 != (unsigned int)-1 && ce2 != (unsigned int)-1)
             ret = ((ce1 >> 4) & 0x0f) - ((ce2 >> 4) & 0x0f);
@@ -324,6 +330,62 @@ static inline int compare_case_weights(int flags, const WCHAR *str1, int len1,
     return len1 - len2;
 }
 
+/* Compare the three weight levels in a single pass. This is only possible
+ * when no character needs to be skipped, since the primary weight pass skips
+ * hyphens and apostrophes while the other passes don't. Returns FALSE if the
+ * generic comparison needs to be used instead.
+ */
+static inline int compare_weights_single_pass(int flags, const WCHAR *str1, int len1,
+                                              const WCHAR *str2, int len2, int *ret)
+{
+    unsigned int ce1, ce2;
+    int diacritic = 0, case_diff = 0, res;
+
+    if (flags & NORM_IGNORESYMBOLS) return 0;
+
+    while (len1 > 0 && len2 > 0)
+    {
+        if (!(flags & SORT_STRINGSORT) &&
+            (*str1 == '-' || *str1 == '\'' || *str2 == '-' || *str2 == '\''))
+            return 0;
+
+        if (*str1 != *str2)
+        {
+            ce1 = get_collation_element(*str1);
+            ce2 = get_collation_element(*str2);
+
+            if (ce1 != (unsigned int)-1 && ce2 != (unsigned int)-1)
+            {
+                /* early exit on the first primary weight difference */
+                if ((res = (ce1 >> 16) - (ce2 >> 16)))
+                {
+                    *ret = res;
+                    return 1;
+                }
+                if (!diacritic) diacritic = ((ce1 >> 8) & 0xff) - ((ce2 >> 8) & 0xff);
+                if (!case_diff) case_diff = ((ce1 >> 4) & 0x0f) - ((ce2 >> 4) & 0x0f);
+            }
+            else
+            {
+                *ret = *str1 - *str2;
+                return 1;
+            }
+        }
+        str1++;
+        str2++;
+        len1--;
+        len2--;
+    }
+
+    if (!(res = len1 - len2))
+    {
+        if (!(flags & NORM_IGNORENONSPACE)) res = diacritic;
+        if (!res && !(flags & NORM_IGNORECASE)) res = case_diff;
+    }
+    *ret = res;
+    return 1;
+}
+
 static inline int real_length(const WCHAR *str, int len)
 {
     while (len && !str[len - 1]) len--;
@@ -338,6 +400,9 @@ int wine_compare_string(int flags, const WCHAR *str1, int len1,
     len1 = real_length(str1, len1);
     len2 = real_length(str2, len2);
 
+    if (compare_weights_single_pass(flags, str1, len1, str2, len2, &ret))
+        return ret;
+
     ret = compare_unicode_weights(flags, str1, len1, str2, len2);
     if (!ret)
     {
@@ -40,6 +40,7 @@
 typedef struct _INCL_FILE
 {
     struct list        entry;
+    struct list        hash_entry;
     char              *name;
     char              *filename;
     char              *sourcename;    /* source file name for generated headers */
@@ -53,6 +54,11 @@ typedef struct _INCL_FILE
 static struct list sources = LIST_INIT(sources);
 static struct list includes = LIST_INIT(includes);
 
+#define HASH_SIZE 137
+
+static struct list src_hash[HASH_SIZE];
+static struct list incl_hash[HASH_SIZE];
+
 typedef struct _OBJECT_EXTENSION
 {
     struct list entry;
@@ -249,6 +255,16 @@ static void add_include_path( const char *name )
     path->name = name;
 }
 
+/*******************************************************************
+ *         hash_filename
+ */
+static unsigned int hash_filename( const char *name )
+{
+    unsigned int ret = 0;
+    while (*name) ret = (ret << 7) + (ret << 3) + *name++;
+    return ret % HASH_SIZE;
+}
+
 /*******************************************************************
  *         find_src_file
  */
@@ -256,7 +272,7 @@ static INCL_FILE *find_src_file( const char *name )
 {
     INCL_FILE *file;
 
-    LIST_FOR_EACH_ENTRY( file, &sources, INCL_FILE, entry )
+    LIST_FOR_EACH_ENTRY( file, &src_hash[hash_filename( name )], INCL_FILE, hash_entry )
         if (!strcmp( name, file->name )) return file;
     return NULL;
 }
@@ -268,7 +284,7 @@ static INCL_FILE *find_include_file( const char *name )
 {
     INCL_FILE *file;
 
-    LIST_FOR_EACH_ENTRY( file, &includes, INCL_FILE, entry )
+    LIST_FOR_EACH_ENTRY( file, &incl_hash[hash_filename( name )], INCL_FILE, hash_entry )
         if (!strcmp( name, file->name )) return file;
     return NULL;
 }
@@ -319,8 +335,7 @@ static INCL_FILE *add_include( INCL_FILE *pFile, const char *name, int line, int
                          pFile->filename, line );
     }
 
-    LIST_FOR_EACH_ENTRY( include, &includes, INCL_FILE, entry )
-        if (!strcmp( name, include->name )) goto found;
+    if ((include = find_include_file( name ))) goto found;
 
     include = xmalloc( sizeof(INCL_FILE) );
     memset( include, 0, sizeof(INCL_FILE) );
@@ -329,6 +344,7 @@ static INCL_FILE *add_include( INCL_FILE *pFile, const char *name, int line, int
     include->included_line = line;
     include->system = system;
     list_add_tail( &includes, &include->entry );
+    list_add_tail( &incl_hash[hash_filename( name )], &include->hash_entry );
 found:
     pFile->files[pos] = include;
     return include;
@@ -829,6 +845,7 @@ static INCL_FILE *add_src_file( const char *name )
     memset( file, 0, sizeof(*file) );
     file->name = xstrdup(name);
     list_add_tail( &sources, &file->entry );
+    list_add_tail( &src_hash[hash_filename( name )], &file->hash_entry );
     parse_file( file, 1 );
     return file;
 }
@@ -1080,6 +1097,12 @@ int main( int argc, char *argv[] )
     if ((ProgramName = strrchr( argv[0], '/' ))) ProgramName++;
     else ProgramName = argv[0];
 
+    for (i = 0; i < HASH_SIZE; i++)
+    {
+        list_init( &src_hash[i] );
+        list_init( &incl_hash[i] );
+    }
+
     i = 1;
     while (i < argc)
     {